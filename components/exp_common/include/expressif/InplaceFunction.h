@@ -0,0 +1,136 @@
+#ifndef EXPRESSIF_INPLACEFUNCTION_H
+#define EXPRESSIF_INPLACEFUNCTION_H
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace expressif {
+template<typename Signature, size_t Capacity = 4 * sizeof(void*), size_t Alignment = alignof(std::max_align_t)>
+class InplaceFunction;
+
+/**
+ * <h1>InplaceFunction</h1>
+ *
+ * Move-only replacement of std::function, which never allocates: the callable is
+ * stored in the inline buffer of [Capacity] bytes. Callables that do not fit are
+ * rejected at compile time:
+ * <pre>
+ * InplaceFunction<void(int), 8> f = [a = 1, b = 2](int x) { ... };  // ok
+ * InplaceFunction<void(int), 8> g = [s = std::string()](int x) { ... };  // error
+ * </pre>
+ * The call is dispatched through a single function pointer stored in the object.
+ * Trivially copyable callables, e.g. lambdas capturing only references and
+ * pointers, are moved with memcpy and need no destructor.
+ * @tparam R The return type
+ * @tparam Args The argument types
+ * @tparam Capacity The size of the inline buffer (in bytes)
+ * @tparam Alignment The alignment of the inline buffer
+ */
+template<typename R, typename... Args, size_t Capacity, size_t Alignment>
+class InplaceFunction<R(Args...), Capacity, Alignment> {
+public:
+    using result_type = R;
+
+public:
+    InplaceFunction() noexcept = default;
+
+    InplaceFunction(std::nullptr_t) noexcept {}
+
+    template<typename F>
+    requires (!std::is_same_v<std::decay_t<F>, InplaceFunction>) && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>
+    InplaceFunction(F &&callable) {
+        using T = std::decay_t<F>;
+
+        static_assert(sizeof(T) <= Capacity, "The callable does not fit into InplaceFunction, increase its capacity");
+        static_assert(alignof(T) <= Alignment, "The callable is over-aligned for InplaceFunction");
+        static_assert(std::is_nothrow_move_constructible_v<T>, "The callable must be nothrow move constructible");
+
+        ::new (static_cast<void*>(m_storage)) T(std::forward<F>(callable));
+
+        m_invoke = [](void *storage, Args... args) -> R {
+            return std::invoke(*static_cast<T*>(storage), std::forward<Args>(args)...);
+        };
+
+        if constexpr (!std::is_trivially_copyable_v<T>) {
+            m_manage = [](void *dst, void *src) noexcept {
+                if (dst != nullptr)
+                    ::new (dst) T(std::move(*static_cast<T*>(src)));
+                static_cast<T*>(src)->~T();
+            };
+        }
+    }
+
+    InplaceFunction(InplaceFunction &&other) noexcept {
+        moveFrom(other);
+    }
+
+    InplaceFunction& operator=(InplaceFunction &&other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction&) = delete;
+    InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+    ~InplaceFunction() {
+        reset();
+    }
+
+    R operator()(Args... args) const {
+        return m_invoke(m_storage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept {
+        return m_invoke != nullptr;
+    }
+
+private:
+    // moves the callable from src to dst (if not null) and destroys it in src
+    using Manager = void (*)(void *dst, void *src) noexcept;
+    using Invoker = R (*)(void *storage, Args... args);
+
+    void moveFrom(InplaceFunction &other) noexcept {
+        if (!other)
+            return;
+
+        if (other.m_manage != nullptr) {
+            other.m_manage(m_storage, other.m_storage);
+        } else {
+            std::memcpy(m_storage, other.m_storage, Capacity);
+        }
+
+        m_invoke = std::exchange(other.m_invoke, nullptr);
+        m_manage = std::exchange(other.m_manage, nullptr);
+    }
+
+    void reset() noexcept {
+        if (m_manage != nullptr)
+            m_manage(nullptr, m_storage);
+
+        m_invoke = nullptr;
+        m_manage = nullptr;
+    }
+
+private:
+    Invoker m_invoke {nullptr};
+    Manager m_manage {nullptr};
+
+    // mutable: the callable is invoked as non-const, the same as std::function does
+    alignas(Alignment) mutable std::byte m_storage[Capacity];
+};
+}
+
+#endif //EXPRESSIF_INPLACEFUNCTION_H
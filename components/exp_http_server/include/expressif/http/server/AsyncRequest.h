@@ -0,0 +1,88 @@
+#ifndef EXPRESSIF_ASYNCREQUEST_H
+#define EXPRESSIF_ASYNCREQUEST_H
+
+#include <esp_http_server.h>
+
+#include <memory>
+
+#include "Response.h"
+
+namespace expressif::http::server {
+class Request;
+
+namespace detail {
+class RequestContext;
+class Coroutine;
+}
+
+/**
+ * <h1>AsyncRequest</h1>
+ *
+ * The request detached from the server task, see Request::detach.
+ * Owns the request: it can be moved to another task and responded to later,
+ * while the server keeps serving other connections. The request is completed
+ * when the object is destroyed or AsyncRequest::complete is called;
+ * the connection is not processed further until then.
+ * <pre>
+ * server.addEndpoint(HTTPMethod::Get, "/api/slow", [](Request &req) {
+ *     auto async = new AsyncRequest(req.detach());
+ *
+ *     xTaskCreate([](void *arg) {
+ *         std::unique_ptr<AsyncRequest> async(static_cast<AsyncRequest*>(arg));
+ *         async->response().write(doSomethingSlow());
+ *         vTaskDelete(nullptr);
+ *     }, "slow", 4096, async, 5, nullptr);
+ * });
+ * </pre>
+ */
+class AsyncRequest {
+public:
+    /**
+     * Creates an invalid request.
+     */
+    AsyncRequest();
+
+    AsyncRequest(AsyncRequest &&other) noexcept;
+    AsyncRequest& operator=(AsyncRequest &&other) noexcept;
+
+    AsyncRequest(const AsyncRequest&) = delete;
+    AsyncRequest& operator=(const AsyncRequest&) = delete;
+
+    ~AsyncRequest();
+
+    /**
+     * @return The request. Its address does not change when AsyncRequest is moved.
+     */
+    Request& request();
+
+    /**
+     * @see Request::response
+     */
+    Response response();
+
+    /**
+     * Releases the request, after that the object becomes invalid.
+     * @note The response must have been sent before, otherwise the connection is closed.
+     * @return ESP_OK in case of success
+     */
+    esp_err_t complete();
+
+    bool isValid() const;
+
+private:
+    friend class Request;
+    friend class HTTPServer;
+    friend class detail::Coroutine;
+
+    AsyncRequest(httpd_req_t *req, std::unique_ptr<detail::RequestContext> context, std::unique_ptr<Request> request);
+
+private:
+    httpd_req_t *m_req;
+    std::unique_ptr<detail::RequestContext> m_context;
+
+    // on the heap: Response keeps a reference to Request's httpd_req_t pointer
+    std::unique_ptr<Request> m_request;
+};
+}
+
+#endif //EXPRESSIF_ASYNCREQUEST_H
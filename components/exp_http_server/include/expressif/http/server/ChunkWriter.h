@@ -0,0 +1,95 @@
+#ifndef EXPRESSIF_CHUNKWRITER_H
+#define EXPRESSIF_CHUNKWRITER_H
+
+#include <array>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+
+#include "Response.h"
+
+namespace expressif::http::server {
+/**
+ * Collects small writes into a buffer of CONFIG_HTTP_SERVER_WRITER_BUFFER_SIZE
+ * bytes and sends it with Response::writeChunk once it is full, so the memory
+ * usage does not depend on the size of the response. Blocks that do not fit
+ * into the buffer are sent directly, without copying.
+ * <br>The first error is remembered, the subsequent writes are ignored.
+ */
+class ChunkWriter {
+public:
+    enum class Escape {
+        None,
+        Html, ///< `&<>"'` are replaced with the character references
+        Uri,  ///< percent-encoding, see URIUtils::EscapeMode::HTML
+        Json  ///< the content of a JSON string
+    };
+
+public:
+    explicit ChunkWriter(Response response);
+
+    ChunkWriter(const ChunkWriter&) = delete;
+    ChunkWriter& operator=(const ChunkWriter&) = delete;
+
+    ChunkWriter& write(std::string_view str);
+    ChunkWriter& write(char c);
+
+    /**
+     * Escapes the string in the same pass as it is written.
+     * @param str The string to be written
+     * @param escape The escape algorithm
+     */
+    ChunkWriter& write(std::string_view str, Escape escape);
+
+    /**
+     * Formats the number using std::to_chars.
+     */
+    template<typename T> requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+    ChunkWriter& writeNumber(T value);
+
+    /**
+     * Sends the buffered data as a chunk.
+     * @return The status of the writer
+     */
+    esp_err_t flush();
+
+    /**
+     * Sends the buffered data and finishes the response.
+     * @return The status of the writer
+     */
+    esp_err_t finish();
+
+    /**
+     * @return ESP_OK or the first error occurred
+     */
+    esp_err_t getStatus() const;
+
+    Response& getResponse();
+
+private:
+    void writeJson(std::string_view str);
+    void writeHtml(std::string_view str);
+    void writeUri(std::string_view str);
+
+private:
+    Response m_response;
+    std::array<char, CONFIG_HTTP_SERVER_WRITER_BUFFER_SIZE> m_buffer;
+    size_t m_size {0};
+    esp_err_t m_status {ESP_OK};
+};
+
+template<typename T> requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+ChunkWriter& ChunkWriter::writeNumber(T value) {
+    char str[32];
+
+    if (auto [end, ec] = std::to_chars(str, str + sizeof(str), value); ec == std::errc()) {
+        write({str, end});
+    } else {
+        m_status = ESP_ERR_INVALID_ARG;
+    }
+
+    return *this;
+}
+}
+
+#endif //EXPRESSIF_CHUNKWRITER_H
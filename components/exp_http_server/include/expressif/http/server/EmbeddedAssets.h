@@ -0,0 +1,100 @@
+#ifndef EXPRESSIF_EMBEDDEDASSETS_H
+#define EXPRESSIF_EMBEDDEDASSETS_H
+
+#include <string>
+#include <string_view>
+#include <span>
+#include <cstdint>
+
+#include "Buffer.h"
+#include "Request.h"
+#include "HandlerResult.h"
+
+namespace expressif::http::server {
+/**
+ * An asset compiled into the firmware. Tables of assets are generated
+ * by `tools/embed_assets.py` of the component, see `expressif_embed_assets` in
+ * `project_include.cmake`.
+ */
+struct EmbeddedAsset {
+    uint32_t pathHash;
+    std::string_view path;
+    ConstBuffer data;
+    std::string_view type;
+    std::string_view etag;
+
+    /// The content coding, e.g. `gzip`, empty for the original content
+    std::string_view encoding;
+
+    /**
+     * Calculates 32-bit FNV-1a hash of the path.
+     */
+    constexpr static uint32_t hashPath(std::string_view path) {
+        uint32_t hash = 0x811c9dc5;
+
+        for (auto c : path) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x01000193;
+        }
+
+        return hash;
+    }
+
+    /**
+     * Checks that the table is sorted by path hash, as required
+     * by EmbeddedAssetHandler. Intended for `static_assert`.
+     */
+    constexpr static bool isSorted(std::span<const EmbeddedAsset> assets) {
+        for (size_t i = 1; i < assets.size(); ++i) {
+            if (assets[i - 1].pathHash > assets[i].pathHash) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+/**
+ * <h1>EmbeddedAssetHandler</h1>
+ *
+ * Serves assets compiled into the firmware, e.g.:
+ * <pre>
+ * server.addEndpoint(HTTPMethod::Get, "/{file}*", EmbeddedAssetHandler(web::assets));
+ * </pre>
+ *
+ * Assets are looked up by path hash and sent directly from flash
+ * without copying. Compressed variants of an asset are picked according to
+ * `Accept-Encoding`, conditional requests are answered with 304.
+ */
+class EmbeddedAssetHandler {
+public:
+    /**
+     * @param assets The table of assets, sorted by path hash; for each path
+     * the variants must be listed in order of preference
+     * @param pathVar The name of the path variable containing the asset path
+     * @param indexFile The asset to be served if the path is empty
+     */
+    explicit EmbeddedAssetHandler(
+            std::span<const EmbeddedAsset> assets,
+            std::string_view pathVar = "file",
+            std::string_view indexFile = "index.html");
+
+    HandlerResult operator()(Request &req) const;
+
+    /**
+     * Finds the most preferred variant of the asset acceptable by the client.
+     * @param path The asset path
+     * @param acceptEncoding The `Accept-Encoding` header value
+     * @return The asset or `nullptr` if there is no such asset
+     */
+    const EmbeddedAsset* find(std::string_view path, std::string_view acceptEncoding) const;
+
+private:
+    std::span<const EmbeddedAsset> m_assets;
+    std::string m_pathVar;
+    std::string m_indexFile;
+};
+}
+
+#endif //EXPRESSIF_EMBEDDEDASSETS_H
@@ -1,28 +1,48 @@
 #ifndef EXPRESSIF_ENDPOINTHANDLER_H
 #define EXPRESSIF_ENDPOINTHANDLER_H
 
-#include <functional>
+#include <expressif/InplaceFunction.h>
 
 #include "Request.h"
 #include "HandlerResult.h"
+#include "Task.h"
+#include "sdkconfig.h"
 
 namespace expressif::http::server {
-using EndpointHandler = std::function<HandlerResult(Request&)>;
+/**
+ * The inline capacity of the handlers, the larger ones are rejected at compile time.
+ * @see CONFIG_HTTP_SERVER_HANDLER_CAPACITY
+ */
+constexpr size_t HandlerCapacity = CONFIG_HTTP_SERVER_HANDLER_CAPACITY * sizeof(void*);
+
+using EndpointHandler = InplaceFunction<HandlerResult(Request&), HandlerCapacity>;
+
+/**
+ * The handler of the coroutine endpoint, see HTTPServer::addEndpoint.
+ */
+using CoroutineHandler = InplaceFunction<Task<HandlerResult>(Request&), HandlerCapacity>;
 
 namespace detail {
 template<typename T>
 using is_complete_endpoint_handler =
-        std::is_invocable_r<EndpointHandler::result_type, T, EndpointHandler::argument_type>;
+        std::is_invocable_r<HandlerResult, T, Request&>;
 
 template<typename T>
 using is_partial_endpoint_handler =
-        std::is_invocable_r<void, T, EndpointHandler::argument_type>;
+        std::is_invocable_r<void, T, Request&>;
+
+template<typename T>
+using is_coroutine_endpoint_handler =
+        std::is_invocable_r<Task<HandlerResult>, T, Request&>;
 
 template<typename T>
 constexpr static bool is_complete_endpoint_handler_v = is_complete_endpoint_handler<T>::value;
 
 template<typename T>
 constexpr static bool is_partial_endpoint_handler_v = is_partial_endpoint_handler<T>::value;
+
+template<typename T>
+constexpr static bool is_coroutine_endpoint_handler_v = is_coroutine_endpoint_handler<T>::value;
 }
 }
 
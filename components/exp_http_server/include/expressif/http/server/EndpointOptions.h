@@ -0,0 +1,77 @@
+#ifndef EXPRESSIF_ENDPOINTOPTIONS_H
+#define EXPRESSIF_ENDPOINTOPTIONS_H
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "RateLimit.h"
+
+namespace expressif::http::server {
+/**
+ * Response caching policy of an endpoint.
+ * @see EndpointOptions::cache
+ */
+struct CachePolicy {
+    /// How long a cached response is served without calling the handler
+    std::chrono::milliseconds ttl {1000};
+
+    /// The request headers the response depends on (e.g. `Accept-Language`),
+    /// their values become a part of the cache key
+    std::vector<std::string> keyHeaders;
+};
+
+/**
+ * The priority of an endpoint under load.
+ * @see EndpointOptions::priority
+ */
+enum class LoadPriority {
+    Normal,  ///< rejected with 503 Service Unavailable while the server is overloaded
+    Critical ///< always served, e.g. health checks and control APIs
+};
+
+/**
+ * Optional per-endpoint settings.
+ */
+struct EndpointOptions {
+    /**
+     * If set, successful (200) responses to GET requests are cached and served
+     * without calling the handler until they expire or are invalidated.
+     * Responses with `Set-Cookie` or `Cache-Control: no-store` are not cached.
+     * @see HTTPServer::invalidateCache
+     */
+    std::optional<CachePolicy> cache;
+
+    /**
+     * Whether the handler runs in the worker pool instead of the server task.
+     * If not set, the default of the pool is used.
+     * @see HTTPServer::startWorkerPool
+     */
+    std::optional<bool> offload;
+
+    /**
+     * Whether the stack high-water mark and the heap usage across the handler
+     * calls are tracked, e.g. to size Config::stack_size. Exposed with the
+     * other metrics, see HTTPServer::writeMetrics. The stack is recorded only
+     * when the call lowers the high-water mark of its task.
+     * @note Requires CONFIG_HTTP_SERVER_METRICS. Coroutine endpoints
+     * are not tracked.
+     */
+    bool trackResources {false};
+
+    /**
+     * If set, limits the rate of the requests from each client to this endpoint,
+     * in addition to the global limit.
+     * @see HTTPServer::setRateLimit
+     */
+    std::optional<RateLimit> rateLimit;
+
+    /**
+     * @see HTTPServer::setLoadShedding
+     */
+    LoadPriority priority {LoadPriority::Normal};
+};
+}
+
+#endif //EXPRESSIF_ENDPOINTOPTIONS_H
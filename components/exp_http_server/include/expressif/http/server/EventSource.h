@@ -0,0 +1,94 @@
+#ifndef EXPRESSIF_EVENTSOURCE_H
+#define EXPRESSIF_EVENTSOURCE_H
+
+#include <esp_http_server.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "Request.h"
+
+namespace expressif::http::server {
+namespace detail {
+class SessionQueues;
+}
+
+/**
+ * <h1>EventSource</h1>
+ *
+ * Server-Sent Events endpoint, see HTTPServer::addEventSource.
+ * The connection stays open after the handler returns; events can be pushed
+ * from any task. Each event is formatted once and queued for the clients,
+ * the actual sending is performed by the server task via `httpd_queue_work`.
+ * <br>Each client has a bounded queue of CONFIG_HTTP_SERVER_SSE_QUEUE_SIZE
+ * events: if the client is too slow, the oldest events are dropped.
+ */
+class EventSource {
+public:
+    using ClientId = int;
+
+    using OpenHandler = std::function<void(Request&, ClientId)>;
+    using CloseHandler = std::function<void(ClientId)>;
+
+public:
+    EventSource(const EventSource&) = delete;
+    EventSource& operator=(const EventSource&) = delete;
+
+    /**
+     * Sends the event to the client. Thread-safe.
+     * @param client The client
+     * @param data The data, may contain multiple lines
+     * @param event The event type, omitted if empty
+     * @param id The event id, omitted if empty
+     * @return `false` if there is no such client or the event cannot be queued
+     */
+    bool send(ClientId client, std::string_view data, std::string_view event = {}, std::string_view id = {});
+
+    /**
+     * Sends the event to all clients. Thread-safe.
+     * @see EventSource::send
+     * @return The number of clients the event has been queued for
+     */
+    size_t broadcast(std::string_view data, std::string_view event = {}, std::string_view id = {});
+
+    size_t getClientCount() const;
+
+    /**
+     * Sets the handler called in the server task once the client has connected.
+     * Must be set before the clients connect.
+     */
+    void setOnOpen(OpenHandler handler);
+
+    /**
+     * Sets the handler called in the server task once the client has disconnected,
+     * or in the task removing the endpoint of the event source.
+     * Must be set before the clients connect.
+     */
+    void setOnClose(CloseHandler handler);
+
+private:
+    friend class HTTPServer;
+
+private:
+    EventSource();
+
+    esp_err_t open(Request &req);
+    void close(ClientId client);
+
+    // closes the connections of all clients, once the endpoint is removed
+    void closeAll(httpd_handle_t handle);
+
+    static std::shared_ptr<const std::string> format(
+            std::string_view data, std::string_view event, std::string_view id);
+
+private:
+    std::shared_ptr<detail::SessionQueues> m_sessions;
+
+    OpenHandler m_onOpen;
+    CloseHandler m_onClose;
+};
+}
+
+#endif //EXPRESSIF_EVENTSOURCE_H
@@ -4,20 +4,37 @@
 #include "Request.h"
 #include "HTTPMethod.h"
 #include "EndpointHandler.h"
+#include "EndpointOptions.h"
+#include "EventSource.h"
+#include "LoadSheddingConfig.h"
+#include "Middleware.h"
+#include "Session.h"
+#include "SessionConfig.h"
+#include "SocketOptions.h"
+#include "WebSocket.h"
+#include "WorkerPoolConfig.h"
 
-#include <functional>
 #include <memory>
+#include <mutex>
 
 namespace expressif::http::server {
 namespace detail {
+class CoroutineScheduler;
 class EndpointData;
+class LoadMonitor;
+class RateLimiter;
+class RequestContext;
+class ResponseCache;
+class ServerMetrics;
+class SessionManager;
+class WorkerPool;
 }
 
 class HTTPServer {
 public:
     using Config = httpd_config_t;
 
-    using ErrorHandler = std::function<HandlerResult(Request&, httpd_err_code_t)>;
+    using ErrorHandler = InplaceFunction<HandlerResult(Request&, httpd_err_code_t), HandlerCapacity>;
 
 public:
     HTTPServer();
@@ -26,14 +43,229 @@ public:
     esp_err_t start(Config config = HTTPD_DEFAULT_CONFIG());
     bool stop();
 
-    bool addEndpoint(HTTPMethod method, std::string_view uriTemplate, EndpointHandler handler);
+    bool addEndpoint(
+            HTTPMethod method, std::string_view uriTemplate,
+            EndpointHandler handler, EndpointOptions options = {});
 
-    // TODO: doc
+    /**
+     * Adds the endpoint. The handler is one of:
+     * <ul>
+     *   <li>HandlerResult(Request&)</li>
+     *   <li>void(Request&), the same as returning HandlerResult::Keep</li>
+     *   <li>Task<HandlerResult>(Request&), the coroutine endpoint</li>
+     * </ul>
+     * Coroutine endpoints are detached from the server task: they are suspended
+     * while waiting for the socket (see Request::readChunkAsync and
+     * Response::writeChunkAsync) and resumed by a single coroutine task,
+     * so slow clients do not block the server.
+     * <pre>
+     * server.addEndpoint(HTTPMethod::Post, "/api/upload", [](Request &req) -> Task<HandlerResult> {
+     *     std::array<byte_t, 128> buff;
+     *     int ret = co_await req.readChunkAsync(buff);
+     *     ...
+     *     co_return HandlerResult::Keep;
+     * });
+     * </pre>
+     * @note The lambda captures are not copied into the coroutine frame,
+     * the coroutine must not use them after the endpoint is removed.
+     * Coroutine endpoints are neither offloaded nor cached.
+     */
     template<typename T>
-    bool addEndpoint(HTTPMethod method, std::string_view uriTemplate, T &&handler);
+    bool addEndpoint(
+            HTTPMethod method, std::string_view uriTemplate,
+            T &&handler, EndpointOptions options = {});
 
     bool removeEndpoint(HTTPMethod method, std::string_view uriTemplate);
 
+    /**
+     * Adds the middleware running before every endpoint, in the order of addition.
+     * The middleware either calls `next()` to continue, or responds itself and
+     * returns without calling it, so the endpoint is not called:
+     * <pre>
+     * server.use([](Request &req, Next &next) {
+     *     if (req.getHeader("X-API-Key") != "secret") {
+     *         auto ret = req.response().error(HTTPD_401_UNAUTHORIZED, "Unauthorized");
+     *         return ret == ESP_OK ? HandlerResult::Keep : HandlerResult::Discard;
+     *     }
+     *
+     *     return next();
+     * });
+     * </pre>
+     * The middleware runs in the server task before the cache lookup, so it can
+     * reject the requests to the cached endpoints as well. For the offloaded
+     * and coroutine endpoints, `next()` returns once the request is handed over.
+     * <br>Statically known stacks can be composed at compile time and added
+     * as a single middleware, see MiddlewareStack.
+     * @note The requests not matching any endpoint are not passed to the middleware.
+     * @param middleware The middleware
+     */
+    void use(Middleware middleware);
+
+    /**
+     * Starts the pool of worker tasks the handlers can be offloaded to, so the
+     * server task keeps accepting connections while the handlers run, possibly
+     * on the other core. The offloaded requests are detached, see Request::detach.
+     * If the queue of the pool is full, 503 Service Unavailable is sent.
+     * @note Must be called while the server is stopped: the pool is used
+     * by the server task without locking.
+     * @param config The configuration of the pool
+     * @param isOffloadedByDefault If `true`, the endpoints without
+     * EndpointOptions::offload are offloaded as well
+     * @return ESP_OK in case of success, ESP_ERR_INVALID_STATE if the server
+     * is running or the pool has already been started
+     */
+    esp_err_t startWorkerPool(const WorkerPoolConfig &config = {}, bool isOffloadedByDefault = false);
+
+    /**
+     * Writes the metrics of the endpoints in the Prometheus text format:
+     * <ul>
+     *   <li>the number of completed requests by status class</li>
+     *   <li>the latency histograms, from receiving the request until it ends</li>
+     *   <li>the sizes of the request and response bodies</li>
+     *   <li>the number of unmatched requests and error handler calls</li>
+     *   <li>the stack and heap usage of the handlers, see EndpointOptions::trackResources</li>
+     *   <li>the counters of the connections, see HTTPServer::getSessionStats</li>
+     * </ul>
+     * The counters are atomic, so they are updated without locking.
+     * The response is streamed in chunks, see ChunkWriter.
+     * @note Requires CONFIG_HTTP_SERVER_METRICS
+     * @param response The response to write the metrics to
+     * @return ESP_OK in case of success, ESP_ERR_NOT_SUPPORTED if the metrics are disabled
+     */
+    esp_err_t writeMetrics(Response response) const;
+
+    /**
+     * Adds the endpoint exposing the metrics, see HTTPServer::writeMetrics.
+     * @param uriTemplate The URI template of the endpoint (GET)
+     */
+    bool addMetricsEndpoint(std::string_view uriTemplate = "/metrics");
+
+    /**
+     * Writes the recent phases of the requests in the Chrome trace event format,
+     * which can be opened in Perfetto or chrome://tracing: routing, handler calls,
+     * body reads and response writes, nested into the spans of the requests.
+     * The spans of the same connection are displayed on the same track.
+     * <br>The spans are recorded into the preallocated ring buffer of
+     * CONFIG_HTTP_SERVER_TRACE_BUFFER_SIZE events, the oldest ones are overwritten.
+     * @note Requires CONFIG_HTTP_SERVER_TRACING
+     * @param response The response to write the trace to
+     * @return ESP_OK in case of success, ESP_ERR_NOT_SUPPORTED if the tracing is disabled
+     */
+    esp_err_t writeTrace(Response response) const;
+
+    /**
+     * Adds the endpoint exposing the trace, see HTTPServer::writeTrace.
+     * @note Requires CONFIG_HTTP_SERVER_TRACING
+     * @param uriTemplate The URI template of the endpoint (GET)
+     */
+    bool addTraceEndpoint(std::string_view uriTemplate = "/trace");
+
+    /**
+     * Adds the Server-Sent Events endpoint. The connections stay open,
+     * events can be pushed via the returned EventSource from any task.
+     * Once the endpoint is removed, the connections of its clients are closed.
+     * @param uriTemplate The URI template of the endpoint (GET)
+     * @return The event source, nullptr in case of error
+     */
+    std::shared_ptr<EventSource> addEventSource(std::string_view uriTemplate);
+
+    /**
+     * Adds the WebSocket endpoint. WebSocket endpoints take precedence over the
+     * regular ones with matching templates.
+     * @note Requires CONFIG_HTTPD_WS_SUPPORT. Each WebSocket endpoint takes one
+     * of Config::max_uri_handlers, 4 more are taken by the regular endpoints.
+     * @param uriTemplate The URI template of the endpoint
+     * @param handlers The handlers
+     * @return The WebSocket endpoint, nullptr in case of error
+     */
+    std::shared_ptr<WebSocket> addWebSocketEndpoint(std::string_view uriTemplate, WebSocket::Handlers handlers);
+
+    /**
+     * Drops all cached responses.
+     * @see EndpointOptions::cache
+     */
+    void invalidateCache();
+
+    /**
+     * Drops the cached responses of the endpoint, e.g. after the data
+     * it serves has changed. Can be called from any task.
+     * @param uriTemplate The template of the endpoint
+     */
+    void invalidateCache(std::string_view uriTemplate);
+
+    /**
+     * Limits the rate of the requests from each client (IP address) to any URI,
+     * including the ones not matching any endpoint. The requests over the limit
+     * are answered with 429 Too Many Requests before the middleware runs.
+     * @note Must be called while the server is stopped: the limiter is used
+     * by the server task without locking.
+     * @see EndpointOptions::rateLimit
+     * @param limit The limit
+     * @return `false` if the server is running
+     */
+    bool setRateLimit(const RateLimit &limit);
+    bool removeRateLimit();
+
+    /**
+     * Enables the admission control: while the server is overloaded, the requests
+     * to the endpoints with LoadPriority::Normal are answered with 503 Service
+     * Unavailable right after routing, without calling the middleware and the
+     * handler. The server is overloaded if any of the following exceeds
+     * its threshold:
+     * <ul>
+     *   <li>the free heap is below LoadSheddingConfig::minFreeHeap</li>
+     *   <li>the number of requests waiting for a worker</li>
+     *   <li>the moving average of the time the requests wait for a worker; it
+     *   expires a second after the last request has been taken by a worker,
+     *   so the shed endpoints get called again</li>
+     * </ul>
+     * The endpoints with LoadPriority::Critical are always served.
+     * @note Must be called while the server is stopped: the monitor is used
+     * by the server and worker tasks without locking.
+     * @param config The thresholds
+     * @return `false` if the server is running
+     */
+    bool setLoadShedding(const LoadSheddingConfig &config = {});
+    bool removeLoadShedding();
+
+    /**
+     * Sets the lifetime of the connections: the idle timeout and the maximum
+     * number of requests per connection (keep-alive). Can be called at any time,
+     * the idle timeout of the open connections is not changed.
+     * @param config The configuration
+     */
+    void setSessionConfig(const SessionConfig &config);
+
+    /**
+     * Sets the options of the sockets, applied to the connections accepted
+     * afterwards, before Config::open_fn is called. Must be called before
+     * HTTPServer::start or from the server task, e.g. in a handler.
+     * <pre>
+     * server.setSocketOptions(SocketOptions::forLatency());
+     * </pre>
+     * @param options The options, see SocketOptions::forLatency and SocketOptions::forThroughput
+     */
+    void setSocketOptions(const SocketOptions &options);
+
+    /**
+     * @return The counters of the connections, including the LRU purges
+     * @see Session
+     */
+    SessionStats getSessionStats() const;
+
+    /**
+     * Sets the handler called in the server task once a connection is accepted,
+     * before its first request. Must be set before the clients connect.
+     * @note Config::open_fn is called before it, and can reject the connection.
+     */
+    void setOnSessionOpen(Session::Handler handler);
+
+    /**
+     * Sets the handler called in the server task once a connection is closed,
+     * before its session is destroyed. Must be set before the clients connect.
+     */
+    void setOnSessionClose(Session::Handler handler);
+
     bool setErrorHandler(httpd_err_code_t error, ErrorHandler handler);
     bool removeErrorHandler(httpd_err_code_t error);
 
@@ -43,15 +275,97 @@ private:
     // calls the corresponding EndpointHandler based on method and uri
     static esp_err_t requestHandler(httpd_req_t *nativeRequest);
 
+    // applies the socket options, creates the session after the user's open_fn
+    static esp_err_t openHandler(httpd_handle_t handle, int sockfd);
+
+    // notifies the event sources and calls the user's close_fn
+    static void closeHandler(httpd_handle_t handle, int sockfd);
+
+    // makes the server task answer the requests with 503 from now on,
+    // so the pool and the coroutines can be destroyed while it is running
+    void rejectRequests();
+
+    // counts the request of the session, the connection is closed after the last one
+    void beginRequest(httpd_req_t *nativeRequest, Request &request, detail::RequestContext &context);
+
+    // calls the handler of the endpoint and caches the response if needed
+    esp_err_t invokeHandler(
+            Request &request, detail::EndpointData &endpoint,
+            std::string &cacheKey, detail::RequestContext &context);
+
+    // serves the request from the cache, offloads it or calls the handler
+    esp_err_t dispatch(
+            httpd_req_t *nativeRequest, Request &request,
+            detail::EndpointData &endpoint, detail::RequestContext &context);
+
+    bool isOffloaded(const detail::EndpointData &endpoint) const;
+
+    bool addCoroutineEndpoint(
+            HTTPMethod method, std::string_view uriTemplate,
+            CoroutineHandler handler, EndpointOptions options);
+
+    bool insertEndpoint(detail::EndpointData &&data);
+
+    // unregisters the event source of the removed endpoint and closes its connections
+    void removeEventSource(std::string_view uriTemplate);
+
+    // see Config::uri_match_fn
+    static bool matchUri(const char *reference, const char *uri, size_t length);
+
+    esp_err_t registerUriHandlers();
+
 private:
     httpd_handle_t m_server;
 
+    // the open_fn and close_fn from the config passed to HTTPServer::start
+    httpd_open_func_t m_openFn {nullptr};
+    httpd_close_func_t m_closeFn {nullptr};
+
+    std::unique_ptr<detail::SessionManager> m_sessions;
+    SocketOptions m_socketOptions;
+    Session::Handler m_onSessionOpen;
+    Session::Handler m_onSessionClose;
+
+private:
+    std::unique_ptr<detail::WorkerPool> m_workers;
+    bool m_isOffloadedByDefault {false};
+
+    // set in the server task by HTTPServer::rejectRequests
+    bool m_isStopping {false};
+
+    // created on demand, when the first coroutine endpoint is added
+    std::unique_ptr<detail::CoroutineScheduler> m_coroutines;
+
+#if CONFIG_HTTP_SERVER_METRICS
+    std::unique_ptr<detail::ServerMetrics> m_metrics;
+#endif
+
 private:
-    // sorted by priority in descending order
-    std::vector<detail::EndpointData> m_endpoints;
+    std::vector<Middleware> m_middleware;
+
+    // the global one, see HTTPServer::setRateLimit
+    std::unique_ptr<detail::RateLimiter> m_rateLimiter;
+
+    // see HTTPServer::setLoadShedding
+    std::unique_ptr<detail::LoadMonitor> m_loadMonitor;
+
+private:
+    // by the URI templates of their endpoints; added from any task,
+    // notified of the closed connections by the server task
+    std::mutex m_eventSourcesMutex;
+    std::vector<std::pair<std::string, std::shared_ptr<EventSource>>> m_eventSources;
+    std::vector<std::shared_ptr<WebSocket>> m_webSockets;
+
+private:
+    // sorted by priority in descending order; shared with the offloaded requests
+    std::vector<std::shared_ptr<detail::EndpointData>> m_endpoints;
 
     decltype(m_endpoints)::iterator findEndpointData(HTTPMethod method, std::string_view uri);
 
+private:
+    // created on demand, when the first endpoint with EndpointOptions::cache is added
+    std::unique_ptr<detail::ResponseCache> m_cache;
+
 private:
     // std::vector instead of std::map to reduce memory usage
     std::vector<std::pair<httpd_err_code_t, ErrorHandler>> m_errorHandlers;
@@ -60,15 +374,20 @@ private:
 };
 
 template<typename T>
-bool HTTPServer::addEndpoint(HTTPMethod method, std::string_view uriTemplate, T &&handler) {
-    if constexpr (detail::is_complete_endpoint_handler_v<T>) {
-        return addEndpoint(method, uriTemplate, EndpointHandler {std::forward<T>(handler)});
+bool HTTPServer::addEndpoint(
+    HTTPMethod method, std::string_view uriTemplate,
+    T &&handler, EndpointOptions options
+) {
+    if constexpr (detail::is_coroutine_endpoint_handler_v<T>) {
+        return addCoroutineEndpoint(method, uriTemplate, CoroutineHandler {std::forward<T>(handler)}, std::move(options));
+    } else if constexpr (detail::is_complete_endpoint_handler_v<T>) {
+        return addEndpoint(method, uriTemplate, EndpointHandler {std::forward<T>(handler)}, std::move(options));
     } else if constexpr (detail::is_partial_endpoint_handler_v<T>) {
         EndpointHandler endpoint = [handler = std::forward<T>(handler)](Request &req) {
             handler(req);
             return HandlerResult::Keep;
         };
-        return addEndpoint(method, uriTemplate, std::move(endpoint));
+        return addEndpoint(method, uriTemplate, std::move(endpoint), std::move(options));
     } else {
         // https://stackoverflow.com/a/64354296/9200394
         []<bool flag = false>() {
@@ -0,0 +1,121 @@
+#ifndef EXPRESSIF_JSONWRITER_H
+#define EXPRESSIF_JSONWRITER_H
+
+#include <bitset>
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+#include "ChunkWriter.h"
+
+namespace expressif::http::server {
+/**
+ * <h1>JsonWriter</h1>
+ *
+ * Streams JSON into the response as it is produced: values are written into
+ * the bounded buffer of ChunkWriter and sent in chunks, so the memory usage
+ * does not depend on the size of the document. The writer sets the
+ * `application/json` content type.
+ *
+ * <h2>Example</h2>
+ * <pre>
+ * JsonWriter json(req.response());
+ * json.beginObject()
+ *     .field("uptime", uptime)
+ *     .key("items").beginArray();
+ *
+ * for (auto &item : items)
+ *     json.value(item);
+ *
+ * json.endArray().endObject();
+ * json.finish();
+ * </pre>
+ *
+ * @note The writer does not validate the structure, besides the nesting depth
+ * (up to JsonWriter::MaxDepth).
+ */
+class JsonWriter {
+public:
+    constexpr static size_t MaxDepth = 32;
+
+public:
+    explicit JsonWriter(Response response);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view str);
+    JsonWriter& value(const char *str);
+    JsonWriter& value(bool b);
+    JsonWriter& value(std::nullptr_t);
+
+    /**
+     * Writes the number formatted using std::to_chars. NaN and infinities,
+     * not representable in JSON, are written as `null`.
+     */
+    template<typename T> requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+    JsonWriter& value(T number);
+
+    /**
+     * Writes already serialized JSON as is.
+     */
+    JsonWriter& rawValue(std::string_view json);
+
+    /**
+     * Shortcut for `key(name).value(value)`.
+     */
+    template<typename T>
+    JsonWriter& field(std::string_view name, T &&value);
+
+    /**
+     * Sends the rest of the document and finishes the response.
+     * @return ESP_OK or the first error occurred
+     */
+    esp_err_t finish();
+
+    esp_err_t getStatus() const;
+
+private:
+    void separate();
+    void push(char bracket);
+    void pop(char bracket);
+
+private:
+    ChunkWriter m_writer;
+
+    // whether the container at the corresponding depth already has elements
+    std::bitset<MaxDepth> m_hasElements;
+    size_t m_depth {0};
+
+    bool m_isAfterKey {false};
+    bool m_isOverflowed {false};
+};
+
+template<typename T> requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+JsonWriter& JsonWriter::value(T number) {
+    if constexpr (std::is_floating_point_v<T>) {
+        if (!std::isfinite(number)) {
+            return value(nullptr);
+        }
+    }
+
+    separate();
+    m_writer.writeNumber(number);
+
+    return *this;
+}
+
+template<typename T>
+JsonWriter& JsonWriter::field(std::string_view name, T &&value) {
+    key(name);
+    return this->value(std::forward<T>(value));
+}
+}
+
+#endif //EXPRESSIF_JSONWRITER_H
@@ -0,0 +1,30 @@
+#ifndef EXPRESSIF_LOADSHEDDINGCONFIG_H
+#define EXPRESSIF_LOADSHEDDINGCONFIG_H
+
+#include <chrono>
+#include <cstddef>
+
+#include "sdkconfig.h"
+
+namespace expressif::http::server {
+/**
+ * The thresholds of the admission control, see HTTPServer::setLoadShedding.
+ * The server is overloaded if any of them is exceeded, 0 disables the check.
+ */
+struct LoadSheddingConfig {
+    /// The minimum free heap (in bytes)
+    size_t minFreeHeap {CONFIG_HTTP_SERVER_SHED_MIN_FREE_HEAP};
+
+    /// The maximum number of requests waiting for a worker, see HTTPServer::startWorkerPool
+    size_t maxQueuedRequests {CONFIG_HTTP_SERVER_SHED_MAX_QUEUED};
+
+    /**
+     * The maximum moving average of the time the offloaded requests wait for
+     * a worker, see HTTPServer::startWorkerPool. The duration of the handlers
+     * is not counted, so the slow transfers do not shed the other endpoints.
+     */
+    std::chrono::milliseconds maxQueueWait {CONFIG_HTTP_SERVER_SHED_MAX_QUEUE_WAIT};
+};
+}
+
+#endif //EXPRESSIF_LOADSHEDDINGCONFIG_H
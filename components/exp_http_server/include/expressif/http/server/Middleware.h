@@ -0,0 +1,128 @@
+#ifndef EXPRESSIF_MIDDLEWARE_H
+#define EXPRESSIF_MIDDLEWARE_H
+
+#include <span>
+#include <tuple>
+#include <utility>
+
+#include "EndpointHandler.h"
+
+namespace expressif::http::server {
+class Next;
+
+/**
+ * The middleware registered at runtime, see HTTPServer::use.
+ */
+using Middleware = InplaceFunction<HandlerResult(Request&, Next&), HandlerCapacity>;
+
+/**
+ * Continues the runtime middleware chain.
+ */
+class Next {
+public:
+    /**
+     * Calls the next middleware or, after the last one, the endpoint.
+     * Must be called at most once.
+     * @return The result of the rest of the chain
+     */
+    HandlerResult operator()() const;
+
+private:
+    friend class HTTPServer;
+
+    using Endpoint = HandlerResult (*)(void *arg);
+
+    Next(Request &request, std::span<const Middleware> chain, Endpoint endpoint, void *arg);
+
+private:
+    Request &m_request;
+    std::span<const Middleware> m_chain;
+    Endpoint m_endpoint;
+    void *m_arg;
+};
+
+namespace detail {
+template<typename H>
+HandlerResult callHandler(H &handler, Request &request) {
+    if constexpr (is_complete_endpoint_handler_v<H&>) {
+        return handler(request);
+    } else {
+        handler(request);
+        return HandlerResult::Keep;
+    }
+}
+}
+
+/**
+ * <h1>MiddlewareStack</h1>
+ *
+ * The middleware composed at compile time: the calls are nested directly,
+ * so the whole stack can be inlined into a single function. A middleware
+ * is a callable `HandlerResult(Request&, auto &&next)`, which either calls
+ * `next()` to continue or responds itself and returns without calling it.
+ * <pre>
+ * constexpr auto cors = [](Request &req, auto &&next) {
+ *     req.response().setHeader("Access-Control-Allow-Origin", "*");
+ *     return next();
+ * };
+ *
+ * constexpr auto auth = [](Request &req, auto &&next) {
+ *     if (req.getHeader("Authorization") != "Bearer secret")
+ *         return req.response().error(HTTPD_401_UNAUTHORIZED, "Unauthorized") == ESP_OK ?
+ *             HandlerResult::Keep : HandlerResult::Discard;
+ *     return next();
+ * };
+ *
+ * constexpr MiddlewareStack api(cors, auth);
+ *
+ * server.addEndpoint(HTTPMethod::Get, "/api/data", api.wrap([](Request &req) { ... }));
+ * server.use(api); // or for all endpoints
+ * </pre>
+ * The same middleware can be used at runtime, see HTTPServer::use.
+ * @note The wrapped handlers run the middleware as a part of the handler,
+ * i.e. after the cache lookup and in the worker if offloaded.
+ * @tparam M The types of the middleware, in the order of calling
+ */
+template<typename ...M>
+class MiddlewareStack {
+public:
+    constexpr explicit MiddlewareStack(M ...middleware)
+        : m_middleware(std::move(middleware)...) {}
+
+    /**
+     * Runs the stack as a single middleware.
+     */
+    template<typename N> requires std::is_invocable_r_v<HandlerResult, N&>
+    HandlerResult operator()(Request &request, N &&next) const {
+        return invoke<0>(request, next);
+    }
+
+    /**
+     * @param handler The handler of the endpoint, HandlerResult(Request&) or void(Request&)
+     * @return The handler running the stack and then the wrapped one
+     */
+    template<typename H>
+    auto wrap(H handler) const {
+        static_assert(detail::is_partial_endpoint_handler_v<H&>, "Unsupported handler's signature");
+
+        return [stack = *this, handler = std::move(handler)](Request &request) -> HandlerResult {
+            return stack(request, [&] { return detail::callHandler(handler, request); });
+        };
+    }
+
+private:
+    template<size_t I, typename N>
+    HandlerResult invoke(Request &request, N &next) const {
+        if constexpr (I == sizeof...(M)) {
+            return next();
+        } else {
+            return std::get<I>(m_middleware)(request, [&] { return invoke<I + 1>(request, next); });
+        }
+    }
+
+private:
+    std::tuple<M...> m_middleware;
+};
+}
+
+#endif //EXPRESSIF_MIDDLEWARE_H
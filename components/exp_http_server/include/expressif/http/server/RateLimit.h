@@ -0,0 +1,27 @@
+#ifndef EXPRESSIF_RATELIMIT_H
+#define EXPRESSIF_RATELIMIT_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace expressif::http::server {
+/**
+ * The limit of the request rate of each client (IP address), see
+ * EndpointOptions::rateLimit and HTTPServer::setRateLimit. The requests
+ * over the limit are answered with 429 Too Many Requests and `Retry-After`
+ * without calling the handler.
+ * <br>The limit is enforced by the generic cell rate algorithm, the token
+ * bucket which stores a single timestamp per client.
+ * @note `period / requests * burst` must not exceed 30 minutes.
+ */
+struct RateLimit {
+    /// The sustained rate: `requests` per `period`
+    uint32_t requests {10};
+    std::chrono::milliseconds period {1000};
+
+    /// The number of requests allowed at once, i.e. the size of the bucket
+    uint32_t burst {10};
+};
+}
+
+#endif //EXPRESSIF_RATELIMIT_H
@@ -3,6 +3,8 @@
 
 #include <esp_http_server.h>
 
+#include <map>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <optional>
@@ -11,14 +13,44 @@
 
 #include "util/PathVars.h"
 #include "HTTPSocketError.h"
+#include "Validators.h"
 #include "Response.h"
+#include "AsyncRequest.h"
+#include "Session.h"
+#include "SocketAwaiter.h"
 
 namespace expressif::http::server {
 class Request {
 public:
     explicit Request(httpd_req_t *req);
 
+    /**
+     * Returns the arena of the request: a bump allocator, which is reset when
+     * the request ends. The headers, query values and bodies can be allocated
+     * from it instead of the heap, see the overloads taking the memory resource;
+     * handlers can use it for their own scratch data as well:
+     * <pre>
+     * auto token = req.getHeader("Authorization", req.getArena());
+     * std::pmr::vector<int> values(req.getArena());
+     * </pre>
+     * @note The data allocated from the arena must not outlive the request.
+     * @return The memory resource of the arena
+     * @see CONFIG_HTTP_SERVER_ARENA_SIZE
+     */
+    std::pmr::memory_resource* getArena() const;
+
+    /**
+     * @return The value of the header, empty if there is no such header
+     */
     std::string getHeader(std::string_view name) const;
+
+    /**
+     * @param resource The memory resource, e.g. Request::getArena
+     * @return The value of the header allocated from the resource,
+     * empty if there is no such header
+     */
+    std::pmr::string getHeader(std::string_view name, std::pmr::memory_resource *resource) const;
+
     bool hasHeader(std::string_view name) const;
 
     /**
@@ -39,30 +71,106 @@ public:
 
     std::string getQueryParam(std::string_view name) const;
 
+    /**
+     * @param resource The memory resource, e.g. Request::getArena
+     * @return The decoded value allocated from the resource,
+     * empty if there is no such parameter
+     */
+    std::pmr::string getQueryParam(std::string_view name, std::pmr::memory_resource *resource) const;
+
     template<typename... Args>
     std::map<std::string, std::string> getQueryParams(Args &&...args) const;
 
     size_t getContentLength() const;
 
+    /**
+     * @return The session of the connection the request is received on,
+     * nullptr if the request is not served by HTTPServer
+     */
+    Session* getSession() const;
+
+    /**
+     * Evaluates the conditional headers (`If-None-Match`, `If-Modified-Since`)
+     * against the specified validators.
+     * @param validators The validators of the current representation
+     * @return `true` if the client's cached copy is still valid
+     */
+    bool isNotModified(const Validators &validators) const;
+
+    /**
+     * Answers the conditional request. If the client's cached copy is still
+     * valid, sends 304 Not Modified, otherwise sets the validator headers
+     * for the upcoming response. Must be called before producing the body:
+     * <pre>
+     * if (req.checkNotModified(validators))
+     *     return;
+     * </pre>
+     * @param validators The validators of the current representation
+     * @return `true` if 304 has been sent, i.e. the body must not be written
+     */
+    bool checkNotModified(const Validators &validators);
+
     int readChunk(Buffer buff) const;
 
+    /**
+     * Reads a chunk of the body from a coroutine endpoint: if no data is
+     * available, the coroutine is suspended until the socket is readable,
+     * meanwhile the other coroutines are served.
+     * <pre>
+     * int ret = co_await req.readChunkAsync(buff);
+     * </pre>
+     * @param buff The buffer, must stay alive until the awaiter is resumed
+     * @return The awaiter producing the same result as Request::readChunk
+     * @see Task
+     */
+    ReadChunkAwaiter readChunkAsync(Buffer buff) const;
+
     template<size_t L = CONFIG_HTTP_SERVER_CHUNK_SIZE, typename C, typename E>
     void readChunks(C &&onRead, E &&onError) const;
 
     template<size_t L = CONFIG_HTTP_SERVER_CHUNK_SIZE, typename C>
     void readChunks(C &&onRead) const;
 
+    /**
+     * Reads the whole body, the memory is reserved for Content-Length up front.
+     * @return The body, std::nullopt in case of error
+     */
     template<size_t L = CONFIG_HTTP_SERVER_CHUNK_SIZE>
     std::optional<std::vector<int8_t>> readAll() const;
 
+    /**
+     * Reads the whole body into the memory allocated from the resource.
+     * @param resource The memory resource, e.g. Request::getArena
+     * @return The body, std::nullopt in case of error
+     */
+    template<size_t L = CONFIG_HTTP_SERVER_CHUNK_SIZE>
+    std::optional<std::pmr::vector<int8_t>> readAll(std::pmr::memory_resource *resource) const;
+
     bool isValid() const;
 
     Response response();
 
+    /**
+     * Detaches the request from the server task, so it can be responded to
+     * later from another task. The server keeps serving other connections
+     * meanwhile. After the call, this object becomes invalid: the returned
+     * AsyncRequest must be used instead.
+     * @note Requests with unread body can be detached as well, the body can
+     * be read from the other task.
+     * @return The detached request, invalid in case of error
+     */
+    AsyncRequest detach();
+
 private:
-    std::string getQueryStr() const;
+    friend class EventSource;
+
+    std::pmr::string getQueryStr() const;
+
+    std::pmr::string getQueryParam(
+            std::string_view queryStr, std::string_view name, std::pmr::memory_resource *resource) const;
 
-    static std::string getQueryParam(std::string_view queryStr, std::string_view name) ;
+    template<size_t L, typename V>
+    std::optional<V> readAllInto(V result) const;
 
 private:
     httpd_req_t *m_req;
@@ -74,11 +182,13 @@ private:
 template<typename ...Args>
 std::map<std::string, std::string> Request::getQueryParams(Args &&...args) const {
     std::map<std::string, std::string> result;
+
+    // the query string is kept in the arena
     auto queryStr = getQueryStr();
 
     // https://en.cppreference.com/w/cpp/language/fold
     ([&] {
-        result[args] = getQueryParam(queryStr, args);
+        result[args] = std::string(getQueryParam(queryStr, args, getArena()));
     } (), ...);
 
     return result;
@@ -120,8 +230,18 @@ void Request::readChunks(C &&onRead) const {
 
 template<size_t L>
 std::optional<std::vector<int8_t>> Request::readAll() const {
-    std::vector<int8_t> result;
-    result.reserve(L);
+    return readAllInto<L>(std::vector<int8_t>());
+}
+
+template<size_t L>
+std::optional<std::pmr::vector<int8_t>> Request::readAll(std::pmr::memory_resource *resource) const {
+    return readAllInto<L>(std::pmr::vector<int8_t>(resource));
+}
+
+template<size_t L, typename V>
+std::optional<V> Request::readAllInto(V result) const {
+    // the arena does not reuse the memory freed on reallocation
+    result.reserve(std::max<size_t>(L, m_req->content_len));
 
     bool error = false;
 
@@ -132,9 +252,10 @@ std::optional<std::vector<int8_t>> Request::readAll() const {
         return false;
     });
 
-    using R = std::invoke_result_t<decltype(&Request::readAll<L>), Request>;
+    if (error)
+        return std::nullopt;
 
-    return error ? R {} : result;
+    return result;
 }
 }
 
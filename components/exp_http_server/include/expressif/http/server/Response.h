@@ -2,14 +2,20 @@
 #define EXPRESSIF_RESPONSE_H
 
 #include <esp_http_server.h>
+#include <esp_partition.h>
 
+#include <string>
 #include <string_view>
 #include <span>
 #include <vector>
 
 #include "Buffer.h"
+#include "Validators.h"
+#include "util/ByteRange.h"
 
 namespace expressif::http::server {
+class WriteChunkAwaiter;
+
 class Response {
 public:
     explicit Response(httpd_req_t *&req);
@@ -18,6 +24,42 @@ public:
     esp_err_t setType(std::string_view type);
     esp_err_t setStatus(std::string_view status);
 
+    /**
+     * Sets `ETag` and `Last-Modified` headers. Empty validators are skipped.
+     * @param validators The validators of the representation
+     * @return ESP_OK in case of success
+     */
+    esp_err_t setValidators(const Validators &validators);
+
+    /**
+     * Enables on-the-fly compression of the response body. The encoding (gzip or
+     * deflate) is negotiated via `Accept-Encoding`. Bodies smaller than [minSize]
+     * are sent uncompressed. Must be called before anything is written; afterwards
+     * the usual write functions can be used as is.
+     * @note Requires CONFIG_HTTP_SERVER_COMPRESSION
+     * @param minSize The minimum body size to be compressed (in bytes)
+     * @return ESP_OK if the compression has been enabled, ESP_ERR_NOT_SUPPORTED if
+     * the client does not accept any of the supported encodings or the compression
+     * is disabled in the config
+     */
+    esp_err_t enableCompression(size_t minSize);
+
+    /**
+     * Enables compression for bodies of at least CONFIG_HTTP_SERVER_COMPRESSION_MIN_SIZE bytes.
+     * @see Response::enableCompression(size_t)
+     */
+    esp_err_t enableCompression();
+
+    /**
+     * Switches the response to the fixed-length mode: instead of the chunked
+     * transfer encoding, `Content-Length` is sent and the written chunks are
+     * sent as is. Exactly [length] bytes must be written before the flush.
+     * @note Cannot be combined with the compression.
+     * @param length The length of the body
+     * @return ESP_OK in case of success
+     */
+    esp_err_t setContentLength(size_t length);
+
     /**
      * Writes buffer and flushes the transmission.
      * @param data The data to be written.
@@ -35,10 +77,80 @@ public:
      */
     esp_err_t writeChunk(ConstBuffer chunk);
 
+    /**
+     * Writes a single chunk to the stream from a coroutine endpoint: the
+     * coroutine is suspended until the socket is writable, meanwhile the
+     * other coroutines are served. The chunk must stay alive until then.
+     * <pre>
+     * if (co_await resp.writeChunkAsync(chunk) != ESP_OK)
+     *     co_return HandlerResult::Discard;
+     * </pre>
+     * @note Include SocketAwaiter.h to use the result.
+     * @param chunk The chunk to be written.
+     * @return The awaiter producing ESP_OK in case of success
+     * @see Task
+     */
+    WriteChunkAwaiter writeChunkAsync(ConstBuffer chunk);
+
     esp_err_t writeChunks(
             ConstBuffer data,
             size_t chunkSize = CONFIG_HTTP_SERVER_CHUNK_SIZE, bool flush = true);
 
+    /**
+     * Streams the range of the partition. The partition is mapped into memory
+     * in windows of CONFIG_HTTP_SERVER_PARTITION_WINDOW_SIZE bytes, each of
+     * them is sent directly, without copying.
+     * @note On the Linux target, the file-backed flash emulation of esp_partition
+     * is used, so the same code can be run on the host.
+     * @param partition The partition
+     * @param offset The offset of the range within the partition
+     * @param size The size of the range
+     * @param flush If `true`, the transmission will be flushed
+     * @return ESP_OK in case of success
+     */
+    esp_err_t writeChunks(const esp_partition_t *partition, size_t offset, size_t size, bool flush = true);
+
+    /**
+     * Sends the range of the partition as the body with `Content-Length`
+     * and flushes the transmission. Honors `Range` requests.
+     * @see Response::writeChunks(const esp_partition_t*, size_t, size_t, bool)
+     * @see Response::writeRanges
+     * @param partition The partition
+     * @param offset The offset of the range within the partition
+     * @param size The size of the range
+     * @param validators The validators of the content, used to evaluate `If-Range`
+     * @return ESP_OK in case of success
+     */
+    esp_err_t writePartition(
+            const esp_partition_t *partition, size_t offset, size_t size,
+            const Validators &validators = {});
+
+    /**
+     * Sends the whole partition.
+     * @see Response::writePartition(const esp_partition_t*, size_t, size_t)
+     */
+    esp_err_t writePartition(const esp_partition_t *partition);
+
+    /**
+     * Sends the representation of [size] bytes honoring `Range` and `If-Range`:
+     * <ul>
+     *   <li>200 with the whole body if there is no applicable `Range`</li>
+     *   <li>206 with a single range</li>
+     *   <li>206 with `multipart/byteranges` in case of multiple ranges</li>
+     *   <li>416 if none of the ranges is satisfiable</li>
+     * </ul>
+     * The body is sent with `Content-Length`, so the content type must be set
+     * beforehand. The reader is called for each requested range and must write
+     * exactly the requested bytes using Response::writeChunk.
+     * @tparam F An invocable type with signature esp_err_t(size_t offset, size_t length)
+     * @param size The size of the representation
+     * @param validators The validators of the representation, used to evaluate `If-Range`
+     * @param reader The reader
+     * @return ESP_OK in case of success
+     */
+    template<typename F>
+    esp_err_t writeRanges(size_t size, const Validators &validators, F &&reader);
+
     /**
      * Writes chunks returned by the factory F. If returned chunk is empty,
      * the function finishes.
@@ -84,6 +196,13 @@ public:
      */
     esp_err_t flush();
 
+    /**
+     * Sends 304 Not Modified with the specified validators and no body.
+     * @param validators The validators of the representation
+     * @return ESP_OK in case of success
+     */
+    esp_err_t notModified(const Validators &validators);
+
     esp_err_t error(httpd_err_code_t code, std::string_view message);
     esp_err_t error404();
     esp_err_t error408();
@@ -92,10 +211,33 @@ public:
 private:
     void invalidate();
 
+    struct RangePart {
+        ByteRange range;
+
+        // multipart delimiter and part headers, empty for a single range
+        std::string head;
+    };
+
+    /**
+     * Evaluates `Range` and `If-Range`, sets the status and the headers.
+     * @param parts The parts to be sent, empty if the response has already been sent
+     * @param tail The closing multipart delimiter, empty for a single range
+     */
+    esp_err_t prepareRanges(
+            size_t size, const Validators &validators,
+            std::vector<RangePart> &parts, std::string &tail);
+
     template<typename T>
     inline static constexpr bool is_chunk_factory =
             std::is_invocable_r_v<ConstBuffer, T>;
 
+    // std::string and std::pmr::string
+    template<typename T>
+    struct is_basic_string : std::false_type {};
+
+    template<typename A>
+    struct is_basic_string<std::basic_string<char, std::char_traits<char>, A>> : std::true_type {};
+
 private:
     httpd_req_t *&m_req;
 };
@@ -115,6 +257,39 @@ esp_err_t Response::writeAll(F &&factory) {
     }
 }
 
+template<typename F>
+esp_err_t Response::writeRanges(size_t size, const Validators &validators, F &&reader) {
+    static_assert(std::is_invocable_r_v<esp_err_t, F, size_t, size_t>);
+
+    std::vector<RangePart> parts;
+    std::string tail;
+
+    if (auto ret = prepareRanges(size, validators, parts, tail); ret != ESP_OK || parts.empty())
+        return ret;
+
+    for (auto &part : parts) {
+        if (!part.head.empty()) {
+            if (auto ret = writeChunk(toBuffer(part.head)); ret != ESP_OK) {
+                return ret;
+            }
+        }
+
+        if (part.range.length > 0) {
+            if (auto ret = reader(part.range.offset, part.range.length); ret != ESP_OK) {
+                return ret;
+            }
+        }
+    }
+
+    if (!tail.empty()) {
+        if (auto ret = writeChunk(toBuffer(tail)); ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    return flush();
+}
+
 template<typename F>
 esp_err_t Response::writeChunks(F &&factory, bool flush) {
     static_assert(is_chunk_factory<F>);
@@ -138,7 +313,7 @@ esp_err_t Response::write(T &&data, size_t chunkSize, bool flush) {
 
     constexpr bool is_string =
             std::is_same_v<U, std::string_view> ||
-            std::is_same_v<U, std::string> ||
+            is_basic_string<U>::value ||
             std::is_same_v<std::remove_const_t<std::remove_pointer_t<U>>, char>;
 
     if constexpr (is_chunk_factory<U>) {
@@ -149,9 +324,9 @@ esp_err_t Response::write(T &&data, size_t chunkSize, bool flush) {
         }
     } else if constexpr (is_string) {
         if (chunkSize > 0) {
-            return writeChunks(toBuffer(data), chunkSize, flush);
+            return writeChunks(toBuffer(std::string_view {data}), chunkSize, flush);
         } else {
-            return writeAll(toBuffer(data));
+            return writeAll(toBuffer(std::string_view {data}));
         }
     } else {
         // https://stackoverflow.com/a/64354296/9200394
@@ -0,0 +1,169 @@
+#ifndef EXPRESSIF_SESSION_H
+#define EXPRESSIF_SESSION_H
+
+#include <esp_http_server.h>
+
+#include <expressif/InplaceFunction.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace expressif::http::server {
+class HTTPServer;
+class Request;
+
+namespace detail {
+class SessionManager;
+}
+
+/**
+ * <h1>Session</h1>
+ *
+ * The state of the connection, kept across its requests (keep-alive),
+ * see Request::getSession. Created when the connection is accepted
+ * and destroyed when it is closed, along with its context.
+ * <br>The context is the state of the application, which otherwise
+ * would be recomputed on every request, e.g. the authenticated user:
+ * <pre>
+ * struct Auth {
+ *     std::string user;
+ * };
+ *
+ * auto &auth = req.getSession()->getContext<Auth>();
+ *
+ * if (auth.user.empty())
+ *     auth.user = authenticate(req.getHeader("Authorization"));
+ * </pre>
+ * @note The requests of the same connection are handled one at a time,
+ * so the session is not accessed concurrently. The session takes
+ * `httpd_req_t::sess_ctx`, it must not be set by the application.
+ */
+class Session {
+public:
+    using Handler = InplaceFunction<void(Session&)>;
+
+public:
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    ~Session();
+
+    int getSocket() const;
+
+    /**
+     * @return The number of requests received on the connection, including the current one
+     */
+    uint32_t getRequestCount() const;
+
+    /**
+     * Overrides SessionConfig::idleTimeout for this connection,
+     * e.g. 0 for the streams which stay open without requests.
+     * @param timeout The idle timeout, 0 keeps the connection open
+     */
+    void setIdleTimeout(std::chrono::milliseconds timeout);
+
+    /**
+     * Returns the context of the session, value-initialized on the first call.
+     * The session has a single context: if it holds one of another type,
+     * it is replaced.
+     * @tparam T The type of the context
+     */
+    template<typename T>
+    T& getContext();
+
+    /**
+     * @tparam T The type of the context
+     * @return The context, nullptr if it has not been created or is of another type
+     */
+    template<typename T>
+    T* findContext();
+
+    /**
+     * Destroys the context, if any.
+     */
+    void resetContext();
+
+private:
+    friend class HTTPServer;
+    friend class Request;
+    friend class detail::SessionManager;
+
+    using Deleter = void (*)(void*);
+
+    Session(httpd_handle_t handle, int sockfd, std::chrono::milliseconds idleTimeout);
+
+    static Session* of(httpd_req_t *req);
+
+    // unique per type without RTTI
+    template<typename T>
+    static const void* getTypeId() {
+        static constexpr char id {};
+        return &id;
+    }
+
+    void setContext(void *context, const void *type, Deleter deleter);
+
+    bool isIdle(uint32_t now) const;
+
+private:
+    httpd_handle_t m_handle;
+    int m_socket;
+    uint32_t m_requestCount {0};
+
+    // the hash of the peer address, looked up once, see detail::RateLimiter
+    uint32_t m_clientKey {0};
+
+    // in milliseconds; the requests may end in the other tasks
+    std::atomic<uint32_t> m_lastActive;
+    std::atomic<uint32_t> m_idleTimeout;
+    std::atomic<bool> m_isBusy {false};
+    std::atomic<bool> m_isClosing {false};
+
+    void *m_context {nullptr};
+    const void *m_contextType {nullptr};
+    Deleter m_deleteContext {nullptr};
+};
+
+/**
+ * The counters of the connections, see HTTPServer::getSessionStats.
+ */
+struct SessionStats {
+    /// The number of open connections
+    uint32_t active {0};
+
+    /// The maximum number of simultaneously open connections
+    uint32_t peak {0};
+
+    /// The number of accepted connections
+    uint32_t opened {0};
+
+    /// The number of requests, and of the ones received on already used connections
+    uint32_t requests {0};
+    uint32_t reusedRequests {0};
+
+    /// The number of connections closed by SessionConfig::idleTimeout
+    uint32_t idleClosed {0};
+
+    /**
+     * The number of connections closed while all Config::max_open_sockets were
+     * taken, i.e. most likely purged to accept a new one (Config::lru_purge_enable)
+     */
+    uint32_t lruPurged {0};
+};
+
+template<typename T>
+T& Session::getContext() {
+    if (m_contextType != getTypeId<T>())
+        setContext(new T(), getTypeId<T>(), [](void *context) { delete static_cast<T*>(context); });
+
+    return *static_cast<T*>(m_context);
+}
+
+template<typename T>
+T* Session::findContext() {
+    return m_contextType == getTypeId<T>() ? static_cast<T*>(m_context) : nullptr;
+}
+}
+
+#endif //EXPRESSIF_SESSION_H
@@ -0,0 +1,35 @@
+#ifndef EXPRESSIF_SESSIONCONFIG_H
+#define EXPRESSIF_SESSIONCONFIG_H
+
+#include <chrono>
+#include <cstdint>
+
+#include "sdkconfig.h"
+
+namespace expressif::http::server {
+/**
+ * The lifetime of the connections, see HTTPServer::setSessionConfig.
+ * The number of connections is limited by Config::max_open_sockets: with
+ * Config::lru_purge_enable, the least recently used one is closed to accept
+ * a new connection, otherwise the new connections wait.
+ */
+struct SessionConfig {
+    /**
+     * The connections without requests for longer than this are closed,
+     * so they do not take the sockets. Checked once per second.
+     * 0 keeps them open until they are purged.
+     * @see Session::setIdleTimeout
+     */
+    std::chrono::milliseconds idleTimeout {CONFIG_HTTP_SERVER_SESSION_IDLE_TIMEOUT};
+
+    /**
+     * The maximum number of requests per connection (keep-alive). The last
+     * response is sent with `Connection: close`, then the connection is closed.
+     * 0 means unlimited, 1 disables keep-alive. The event streams stay open,
+     * see HTTPServer::addEventSource.
+     */
+    uint32_t maxRequests {CONFIG_HTTP_SERVER_SESSION_MAX_REQUESTS};
+};
+}
+
+#endif //EXPRESSIF_SESSIONCONFIG_H
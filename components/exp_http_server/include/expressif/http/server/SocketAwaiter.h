@@ -0,0 +1,103 @@
+#ifndef EXPRESSIF_SOCKETAWAITER_H
+#define EXPRESSIF_SOCKETAWAITER_H
+
+#include <esp_http_server.h>
+
+#include <coroutine>
+
+#include "Buffer.h"
+#include "Response.h"
+
+namespace expressif::http::server {
+namespace detail {
+class Coroutine;
+
+enum class SocketEvent {
+    Read,
+    Write
+};
+
+/**
+ * Suspends the coroutine endpoint until the socket of the request is ready.
+ * Outside of coroutine endpoints, the awaiters never suspend: the operations
+ * block as usual.
+ */
+class SocketAwaiter {
+protected:
+    SocketAwaiter(httpd_req_t *req, SocketEvent event);
+
+    /**
+     * @return The coroutine handling the request, nullptr if the request
+     * is not handled by a coroutine endpoint
+     */
+    Coroutine* getCoroutine() const;
+
+    /**
+     * @return `true` if the socket is ready without waiting
+     */
+    bool isSocketReady() const;
+
+    void suspend(std::coroutine_handle<> handle);
+
+    /**
+     * @return `true` if the awaiter has been resumed because the socket
+     * timeout (`SO_RCVTIMEO` or `SO_SNDTIMEO`) has expired
+     */
+    bool isTimedOut() const;
+
+protected:
+    httpd_req_t *m_req;
+    SocketEvent m_event;
+    bool m_isSuspended {false};
+};
+}
+
+/**
+ * The result of Request::readChunkAsync.
+ */
+class ReadChunkAwaiter : detail::SocketAwaiter {
+public:
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> handle);
+
+    /**
+     * @see Request::readChunk
+     */
+    int await_resume();
+
+private:
+    friend class Request;
+
+    ReadChunkAwaiter(httpd_req_t *req, Buffer buff);
+
+private:
+    Buffer m_buff;
+    int m_result {HTTPD_SOCK_ERR_FAIL};
+};
+
+/**
+ * The result of Response::writeChunkAsync.
+ */
+class WriteChunkAwaiter : detail::SocketAwaiter {
+public:
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> handle);
+
+    /**
+     * @return ESP_OK in case of success, ESP_ERR_TIMEOUT if the client has not
+     * been receiving for too long
+     */
+    esp_err_t await_resume();
+
+private:
+    friend class Response;
+
+    WriteChunkAwaiter(httpd_req_t *req, Response response, ConstBuffer chunk);
+
+private:
+    Response m_response;
+    ConstBuffer m_chunk;
+};
+}
+
+#endif //EXPRESSIF_SOCKETAWAITER_H
@@ -0,0 +1,84 @@
+#ifndef EXPRESSIF_SOCKETOPTIONS_H
+#define EXPRESSIF_SOCKETOPTIONS_H
+
+#include <chrono>
+#include <cstdint>
+
+#include "sdkconfig.h"
+
+namespace expressif::http::server {
+/**
+ * The options of the accepted sockets, see HTTPServer::setSocketOptions.
+ * 0 keeps the value set by esp_http_server or lwIP.
+ * <br>The presets can be compared with `tools/http_bench`, whose results
+ * include the time to the first byte and the latency percentiles.
+ */
+struct SocketOptions {
+    /**
+     * Disables Nagle's algorithm (TCP_NODELAY): the small responses are sent
+     * at once instead of waiting for the ACK of the previous segment, which
+     * the client may delay by up to 200 ms.
+     */
+    bool noDelay {CONFIG_HTTP_SERVER_TCP_NODELAY};
+
+    /**
+     * SO_SNDBUF and SO_RCVBUF (in bytes).
+     * @note lwIP ignores SO_SNDBUF, the send buffer is CONFIG_LWIP_TCP_SND_BUF_DEFAULT;
+     * SO_RCVBUF requires CONFIG_LWIP_SO_RCVBUF.
+     */
+    uint32_t sendBufferSize {0};
+    uint32_t receiveBufferSize {0};
+
+    /**
+     * The TCP keep-alive probes, which detect the peers gone without closing
+     * the connection: the first probe is sent after `keepAliveIdle`, then every
+     * `keepAliveInterval`, the connection is closed after `keepAliveCount`
+     * unanswered ones. Override Config::keep_alive_enable and the related fields.
+     */
+    std::chrono::seconds keepAliveIdle {0};
+    std::chrono::seconds keepAliveInterval {0};
+    uint32_t keepAliveCount {0};
+
+    /**
+     * SO_SNDTIMEO and SO_RCVTIMEO, i.e. how long a send or receive may block
+     * the task. Override Config::send_wait_timeout and Config::recv_wait_timeout.
+     */
+    std::chrono::milliseconds sendTimeout {0};
+    std::chrono::milliseconds receiveTimeout {0};
+
+    /**
+     * The preset for small responses, e.g. JSON APIs: Nagle's algorithm is
+     * disabled, the stalled or gone clients release the server task sooner.
+     */
+    constexpr static SocketOptions forLatency() {
+        return {
+            .noDelay = true,
+            .keepAliveIdle = std::chrono::seconds(10),
+            .keepAliveInterval = std::chrono::seconds(2),
+            .keepAliveCount = 3,
+            .sendTimeout = std::chrono::seconds(2),
+            .receiveTimeout = std::chrono::seconds(2)
+        };
+    }
+
+    /**
+     * The preset for large transfers, e.g. files: Nagle's algorithm coalesces
+     * the chunk headers and bodies into full segments, the buffers are larger
+     * and the slow clients get more time.
+     */
+    constexpr static SocketOptions forThroughput() {
+        return {
+            .noDelay = false,
+            .sendBufferSize = 16384,
+            .receiveBufferSize = 16384,
+            .keepAliveIdle = std::chrono::seconds(60),
+            .keepAliveInterval = std::chrono::seconds(10),
+            .keepAliveCount = 3,
+            .sendTimeout = std::chrono::seconds(10),
+            .receiveTimeout = std::chrono::seconds(10)
+        };
+    }
+};
+}
+
+#endif //EXPRESSIF_SOCKETOPTIONS_H
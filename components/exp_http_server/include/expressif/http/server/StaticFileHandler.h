@@ -0,0 +1,51 @@
+#ifndef EXPRESSIF_STATICFILEHANDLER_H
+#define EXPRESSIF_STATICFILEHANDLER_H
+
+#include <string_view>
+#include <memory>
+
+#include "Request.h"
+#include "HandlerResult.h"
+
+namespace expressif::http::server {
+/**
+ * <h1>StaticFileHandler</h1>
+ *
+ * Serves files from the specified directory, e.g.:
+ * <pre>
+ * server.addEndpoint(HTTPMethod::Get, "/{file}*", StaticFileHandler("/spiffs"));
+ * </pre>
+ *
+ * Responses carry `ETag` and `Last-Modified` headers. The entity tag is the
+ * content hash, calculated once per file and cached until the file's size or
+ * modification time changes. Conditional requests are answered with
+ * 304 Not Modified without opening the file.
+ *
+ * If the client accepts `br` or `gzip` encoding and a precompressed sidecar
+ * exists next to the file (e.g. `index.js.br` or `index.js.gz`), the sidecar
+ * is served instead with the corresponding `Content-Encoding`. Sidecars can be
+ * generated at build time by `tools/compress_assets.py` of the component.
+ */
+class StaticFileHandler {
+public:
+    /**
+     * @param basePath The directory to serve files from, e.g. `/spiffs`
+     * @param pathVar The name of the path variable containing the file path
+     * @param indexFile The file to be served if the path is empty
+     */
+    explicit StaticFileHandler(
+            std::string_view basePath,
+            std::string_view pathVar = "file",
+            std::string_view indexFile = "index.html");
+
+    HandlerResult operator()(Request &req) const;
+
+private:
+    struct State;
+
+    // shared, since handlers are copied on registration
+    std::shared_ptr<State> m_state;
+};
+}
+
+#endif //EXPRESSIF_STATICFILEHANDLER_H
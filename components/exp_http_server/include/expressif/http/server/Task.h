@@ -0,0 +1,228 @@
+#ifndef EXPRESSIF_TASK_H
+#define EXPRESSIF_TASK_H
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdlib>
+#include <optional>
+#include <utility>
+
+namespace expressif::http::server {
+template<typename T>
+class Task;
+
+namespace detail {
+class Coroutine;
+
+/**
+ * Allocates the coroutine frame. Frames of up to CONFIG_HTTP_SERVER_CORO_FRAME_SIZE
+ * bytes are taken from the pool, the others are allocated on the heap.
+ * @param size The size of the frame
+ * @return The frame, nullptr in case of failure
+ */
+void* allocateFrame(size_t size) noexcept;
+
+void deallocateFrame(void *frame, size_t size) noexcept;
+
+class TaskPromiseBase {
+public:
+    // resumes the awaiting coroutine, if any
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
+            if (auto continuation = handle.promise().continuation)
+                return continuation;
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    // exceptions are disabled
+    void unhandled_exception() const noexcept {
+        std::abort();
+    }
+
+    static void* operator new(size_t size) noexcept {
+        return allocateFrame(size);
+    }
+
+    static void operator delete(void *frame, size_t size) noexcept {
+        deallocateFrame(frame, size);
+    }
+
+public:
+    std::coroutine_handle<> continuation;
+};
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+    Task<T> get_return_object() noexcept;
+
+    static Task<T> get_return_object_on_allocation_failure() noexcept;
+
+    template<typename U>
+    void return_value(U &&value) {
+        m_value = std::forward<U>(value);
+    }
+
+    T&& result() {
+        return std::move(*m_value);
+    }
+
+private:
+    std::optional<T> m_value;
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+    Task<void> get_return_object() noexcept;
+
+    static Task<void> get_return_object_on_allocation_failure() noexcept;
+
+    void return_void() const noexcept {}
+
+    void result() const noexcept {}
+};
+}
+
+/**
+ * <h1>Task</h1>
+ *
+ * The lazily started coroutine producing the value of type T. Coroutine endpoints
+ * return Task<HandlerResult>, see HTTPServer::addEndpoint; other tasks can be
+ * awaited from them. The frames are allocated from a fixed pool, see
+ * CONFIG_HTTP_SERVER_CORO_FRAME_SIZE.
+ * <pre>
+ * Task<size_t> skipBody(Request &req) {
+ *     std::array<byte_t, 64> buff;
+ *     size_t size = 0;
+ *
+ *     while (size < req.getContentLength()) {
+ *         int ret = co_await req.readChunkAsync(buff);
+ *         if (ret <= 0)
+ *             break;
+ *         size += ret;
+ *     }
+ *
+ *     co_return size;
+ * }
+ * </pre>
+ * @note Exceptions are disabled: if the frame of an awaited task cannot be
+ * allocated, the program is aborted.
+ * @tparam T The type of the result
+ */
+template<typename T = void>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+public:
+    Task() = default;
+
+    Task(Task &&other) noexcept
+        : m_handle(std::exchange(other.m_handle, {})) {}
+
+    Task& operator=(Task &&other) noexcept {
+        if (this != &other) {
+            reset();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        reset();
+    }
+
+    /**
+     * @return `false` if the frame could not be allocated
+     */
+    bool isValid() const {
+        return static_cast<bool>(m_handle);
+    }
+
+    bool isDone() const {
+        return !m_handle || m_handle.done();
+    }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept {
+                return !handle || handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() {
+                if (!handle)
+                    std::abort();
+                return handle.promise().result();
+            }
+        };
+
+        return Awaiter {m_handle};
+    }
+
+private:
+    friend class detail::TaskPromise<T>;
+    friend class detail::Coroutine;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle) {}
+
+    void reset() {
+        if (m_handle) {
+            std::exchange(m_handle, {}).destroy();
+        }
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace detail {
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T> {std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object_on_allocation_failure() noexcept {
+    return {};
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void> {std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+
+inline Task<void> TaskPromise<void>::get_return_object_on_allocation_failure() noexcept {
+    return {};
+}
+}
+}
+
+#endif //EXPRESSIF_TASK_H
@@ -0,0 +1,244 @@
+#ifndef EXPRESSIF_TEMPLATE_H
+#define EXPRESSIF_TEMPLATE_H
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <string_view>
+#include <utility>
+
+#include "ChunkWriter.h"
+
+namespace expressif::http::server {
+namespace detail {
+template<size_t N>
+struct TemplateSource {
+    constexpr TemplateSource(const char (&str)[N]) {
+        std::copy_n(str, N, data);
+    }
+
+    constexpr std::string_view view() const {
+        return {data, N - 1};
+    }
+
+    char data[N] {};
+};
+
+struct TemplateSegment {
+    // the literal or the name of the placeholder
+    std::string_view text;
+    bool isPlaceholder;
+    ChunkWriter::Escape escape;
+};
+
+// not constexpr: reaching any of them during the compilation results in an error
+inline void template_error_unclosed_placeholder() {}
+inline void template_error_empty_placeholder() {}
+inline void template_error_unknown_escape() {}
+
+constexpr std::string_view trimTemplateName(std::string_view str) {
+    while (!str.empty() && str.front() == ' ')
+        str.remove_prefix(1);
+
+    while (!str.empty() && str.back() == ' ')
+        str.remove_suffix(1);
+
+    return str;
+}
+
+template<typename F>
+constexpr void parseTemplate(std::string_view src, ChunkWriter::Escape defaultEscape, F &&onSegment) {
+    using Escape = ChunkWriter::Escape;
+
+    size_t pos = 0;
+
+    while (pos < src.size()) {
+        auto open = src.find("{{", pos);
+
+        if (open == std::string_view::npos) {
+            onSegment(TemplateSegment {src.substr(pos), false, Escape::None});
+            return;
+        }
+
+        if (open > pos)
+            onSegment(TemplateSegment {src.substr(pos, open - pos), false, Escape::None});
+
+        auto close = src.find("}}", open + 2);
+
+        if (close == std::string_view::npos)
+            template_error_unclosed_placeholder();
+
+        auto name = src.substr(open + 2, close - open - 2);
+        auto escape = defaultEscape;
+
+        if (auto bar = name.find('|'); bar != std::string_view::npos) {
+            auto filter = trimTemplateName(name.substr(bar + 1));
+
+            if (filter == "raw") {
+                escape = Escape::None;
+            } else if (filter == "html") {
+                escape = Escape::Html;
+            } else if (filter == "uri") {
+                escape = Escape::Uri;
+            } else if (filter == "json") {
+                escape = Escape::Json;
+            } else {
+                template_error_unknown_escape();
+            }
+
+            name = name.substr(0, bar);
+        }
+
+        name = trimTemplateName(name);
+
+        if (name.empty())
+            template_error_empty_placeholder();
+
+        onSegment(TemplateSegment {name, true, escape});
+
+        pos = close + 2;
+    }
+}
+
+template<TemplateSource Source, ChunkWriter::Escape DefaultEscape>
+consteval auto compileTemplate() {
+    constexpr size_t count = [] {
+        size_t n = 0;
+        parseTemplate(Source.view(), DefaultEscape, [&n](TemplateSegment) { ++n; });
+        return n;
+    }();
+
+    std::array<TemplateSegment, count> segments {};
+    size_t index = 0;
+
+    parseTemplate(Source.view(), DefaultEscape, [&](TemplateSegment segment) {
+        segments[index++] = segment;
+    });
+
+    return segments;
+}
+}
+
+/**
+ * The placeholder's output passed to the value provider of Template::render.
+ * Strings are escaped according to the placeholder.
+ */
+class TemplateOutput {
+public:
+    TemplateOutput(ChunkWriter &writer, ChunkWriter::Escape escape)
+        : m_writer(writer), m_escape(escape) {}
+
+    inline TemplateOutput& write(std::string_view str) {
+        m_writer.write(str, m_escape);
+        return *this;
+    }
+
+    template<typename T> requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+    inline TemplateOutput& write(T value) {
+        m_writer.writeNumber(value);
+        return *this;
+    }
+
+    /**
+     * @return The underlying writer, e.g. to render a nested template
+     */
+    inline ChunkWriter& getWriter() {
+        return m_writer;
+    }
+
+private:
+    ChunkWriter &m_writer;
+    ChunkWriter::Escape m_escape;
+};
+
+/**
+ * <h1>Template</h1>
+ *
+ * The template is split into the literal and placeholder segments at compile
+ * time. Rendering streams the segments into the response via ChunkWriter:
+ * the page is never composed in memory, and the values are escaped while
+ * being written.
+ *
+ * <h2>Syntax</h2>
+ * <ul>
+ *   <li>{{name}} - the value escaped using the default escape algorithm</li>
+ *   <li>{{name|html}}, {{name|uri}}, {{name|json}}, {{name|raw}} - the value
+ *       escaped using the specified algorithm, see ChunkWriter::Escape</li>
+ * </ul>
+ * Malformed templates do not compile.
+ *
+ * <h2>Example</h2>
+ * <pre>
+ * using Greeting = Template<"<h1>Hello, {{name}}!</h1><a href='/u/{{name|uri}}'>profile</a>">;
+ *
+ * Greeting::render(req.response(), {{"name", name}});
+ *
+ * Greeting::render(req.response(), [&](std::string_view placeholder, TemplateOutput &out) {
+ *     out.write(name);
+ * });
+ * </pre>
+ *
+ * @tparam Source The template
+ * @tparam DefaultEscape The escape algorithm of the placeholders without explicit one
+ */
+template<detail::TemplateSource Source, ChunkWriter::Escape DefaultEscape = ChunkWriter::Escape::Html>
+class Template {
+public:
+    using Value = std::pair<std::string_view, std::string_view>;
+
+    constexpr static auto segments = detail::compileTemplate<Source, DefaultEscape>();
+
+public:
+    /**
+     * Renders the template into the writer.
+     * @tparam F An invocable type with signature void(std::string_view name, TemplateOutput &out)
+     * @param writer The writer
+     * @param provider Writes the value of the placeholder
+     */
+    template<typename F>
+    static void render(ChunkWriter &writer, F &&provider) {
+        static_assert(std::is_invocable_v<F, std::string_view, TemplateOutput&>);
+
+        for (auto &segment : segments) {
+            if (segment.isPlaceholder) {
+                TemplateOutput output(writer, segment.escape);
+                provider(segment.text, output);
+            } else {
+                writer.write(segment.text);
+            }
+        }
+    }
+
+    /**
+     * Renders the template as the response body.
+     * @see Template::render(ChunkWriter&, F&&)
+     * @param response The response
+     * @param provider Writes the value of the placeholder
+     * @param flush If `true`, the transmission will be flushed
+     * @return ESP_OK in case of success
+     */
+    template<typename F>
+    static esp_err_t render(Response response, F &&provider, bool flush = true) {
+        ChunkWriter writer(response);
+        render(writer, std::forward<F>(provider));
+        return flush ? writer.finish() : writer.flush();
+    }
+
+    /**
+     * Renders the template as the response body. Missing values are rendered as empty strings.
+     * @param response The response
+     * @param values The pairs of the placeholder name and its value
+     * @param flush If `true`, the transmission will be flushed
+     * @return ESP_OK in case of success
+     */
+    static esp_err_t render(Response response, std::initializer_list<Value> values, bool flush = true) {
+        return render(response, [values](std::string_view name, TemplateOutput &out) {
+            if (auto it = std::ranges::find(values, name, &Value::first); it != values.end()) {
+                out.write(it->second);
+            }
+        }, flush);
+    }
+};
+}
+
+#endif //EXPRESSIF_TEMPLATE_H
@@ -0,0 +1,21 @@
+#ifndef EXPRESSIF_VALIDATORS_H
+#define EXPRESSIF_VALIDATORS_H
+
+#include <string>
+#include <ctime>
+
+namespace expressif::http::server {
+/**
+ * Cache validators of a representation, used to answer conditional requests.
+ * @see Request::checkNotModified
+ */
+struct Validators {
+    /// The entity tag including quotes, e.g. `"5d8c72a5"` or `W/"5d8c72a5"`, empty if unknown
+    std::string etag;
+
+    /// The last modification time, 0 if unknown
+    time_t lastModified {0};
+};
+}
+
+#endif //EXPRESSIF_VALIDATORS_H
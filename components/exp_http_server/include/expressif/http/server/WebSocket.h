@@ -0,0 +1,122 @@
+#ifndef EXPRESSIF_WEBSOCKET_H
+#define EXPRESSIF_WEBSOCKET_H
+
+#include <esp_http_server.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "Buffer.h"
+#include "Request.h"
+
+namespace expressif::http::server {
+namespace detail {
+class EndpointData;
+class SessionQueues;
+}
+
+/**
+ * <h1>WebSocket</h1>
+ *
+ * WebSocket endpoint, see HTTPServer::addWebSocketEndpoint.
+ * The handshake and the control frames (ping, close) are handled by
+ * esp_http_server, the data frames are passed to Handlers::onMessage.
+ * Frames can be sent from any task: each frame is serialized once and
+ * queued for the clients, the actual sending is performed by the server
+ * task via `httpd_queue_work`.
+ * <br>Each client has a bounded queue of CONFIG_HTTP_SERVER_WS_QUEUE_SIZE
+ * frames: if the client is too slow, the oldest frames are dropped.
+ * @note Requires CONFIG_HTTPD_WS_SUPPORT
+ */
+class WebSocket {
+public:
+    using ClientId = int;
+
+    // the opcodes, see RFC 6455, 5.2
+    enum class FrameType {
+        Continuation = 0x0,
+        Text = 0x1,
+        Binary = 0x2
+    };
+
+    struct Frame {
+        FrameType type;
+
+        /// Points to the receive buffer, valid only during the call to Handlers::onMessage
+        Buffer payload;
+
+        /// `false` if the message is fragmented and more frames follow
+        bool isFinal;
+    };
+
+    struct Handlers {
+        /// Called once the handshake has been completed
+        std::function<void(Request&, ClientId)> onOpen;
+
+        /// Called for each data frame, in the server task
+        std::function<void(ClientId, const Frame&)> onMessage;
+
+        /// Called once the client has disconnected
+        std::function<void(ClientId)> onClose;
+    };
+
+public:
+    WebSocket(const WebSocket&) = delete;
+    WebSocket& operator=(const WebSocket&) = delete;
+
+    ~WebSocket();
+
+    /**
+     * Sends the frame to the client. Thread-safe.
+     * @return `false` if there is no such client or the frame cannot be queued
+     */
+    bool send(ClientId client, ConstBuffer payload, FrameType type = FrameType::Binary);
+    bool send(ClientId client, std::string_view text);
+
+    /**
+     * Sends the frame to all clients. Thread-safe.
+     * @return The number of clients the frame has been queued for
+     */
+    size_t broadcast(ConstBuffer payload, FrameType type = FrameType::Binary);
+    size_t broadcast(std::string_view text);
+
+    size_t getClientCount() const;
+
+private:
+    friend class HTTPServer;
+
+    // distinguishes the WebSocket URI handlers in HTTPServer's uri_match_fn
+    constexpr static std::string_view UriPrefix = "ws:";
+
+private:
+    WebSocket(std::string_view uriTemplate, Handlers handlers);
+
+    const char* getUri() const;
+    std::string_view getUriTemplate() const;
+
+    void close(ClientId client);
+
+    static std::shared_ptr<const std::string> serialize(ConstBuffer payload, FrameType type);
+
+    // the handler of the URI, see httpd_uri_t::handler
+    static esp_err_t handler(httpd_req_t *req);
+
+    esp_err_t onHandshake(httpd_req_t *req);
+    esp_err_t onFrame(httpd_req_t *req);
+
+private:
+    // WebSocket::UriPrefix + template
+    std::string m_uri;
+
+    // for the path variables of the handshake request
+    std::unique_ptr<detail::EndpointData> m_endpoint;
+
+    std::shared_ptr<detail::SessionQueues> m_sessions;
+
+    Handlers m_handlers;
+};
+}
+
+#endif //EXPRESSIF_WEBSOCKET_H
@@ -0,0 +1,31 @@
+#ifndef EXPRESSIF_WORKERPOOLCONFIG_H
+#define EXPRESSIF_WORKERPOOLCONFIG_H
+
+#include <freertos/FreeRTOS.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sdkconfig.h"
+
+namespace expressif::http::server {
+/**
+ * The configuration of the handler worker tasks, see HTTPServer::startWorkerPool.
+ */
+struct WorkerPoolConfig {
+    size_t workerCount {CONFIG_HTTP_SERVER_WORKER_COUNT};
+    uint32_t stackSize {CONFIG_HTTP_SERVER_WORKER_STACK_SIZE};
+    UBaseType_t priority {CONFIG_HTTP_SERVER_WORKER_PRIORITY};
+
+    /// The i-th worker is pinned to `coreIds[i % coreIds.size()]`, e.g. `{0, 1}`
+    /// spreads the workers across both cores. If empty, the workers are not pinned.
+    std::vector<BaseType_t> coreIds;
+
+    /// The maximum number of requests waiting for a worker, the rest are
+    /// answered with 503 Service Unavailable
+    size_t queueSize {CONFIG_HTTP_SERVER_WORKER_QUEUE_SIZE};
+};
+}
+
+#endif //EXPRESSIF_WORKERPOOLCONFIG_H
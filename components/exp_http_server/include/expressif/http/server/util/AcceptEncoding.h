@@ -0,0 +1,25 @@
+#ifndef EXPRESSIF_ACCEPTENCODING_H
+#define EXPRESSIF_ACCEPTENCODING_H
+
+#include <string_view>
+
+namespace expressif::http::server {
+class AcceptEncoding {
+public:
+    /**
+     * Checks whether the content coding is acceptable according to
+     * the `Accept-Encoding` header value, e.g. `gzip, deflate;q=0.5, br;q=0`.
+     * Codings with `q=0` are treated as not acceptable, `*` matches any
+     * coding that is not listed explicitly.
+     * @param header The `Accept-Encoding` header value
+     * @param coding The content coding, e.g. `gzip`
+     * @return `true` if the coding is acceptable
+     */
+    static bool isAccepted(std::string_view header, std::string_view coding);
+
+private:
+    AcceptEncoding() = default;
+};
+}
+
+#endif //EXPRESSIF_ACCEPTENCODING_H
@@ -0,0 +1,31 @@
+#ifndef EXPRESSIF_BYTERANGE_H
+#define EXPRESSIF_BYTERANGE_H
+
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <cstddef>
+
+namespace expressif::http::server {
+struct ByteRange {
+    size_t offset;
+    size_t length;
+
+    /**
+     * The maximum number of ranges in a single request. Requests with more ranges
+     * are served in full, since many small ranges are more expensive to send.
+     */
+    constexpr static size_t MaxCount = 8;
+
+    /**
+     * Parses the `Range` header value (RFC 9110, 14.2), e.g. `bytes=0-499, -500`.
+     * @param header The header value
+     * @param size The size of the representation
+     * @return The satisfiable ranges; an empty vector if none of them is satisfiable;
+     * `std::nullopt` if the header is malformed or not supported and must be ignored
+     */
+    static std::optional<std::vector<ByteRange>> parse(std::string_view header, size_t size);
+};
+}
+
+#endif //EXPRESSIF_BYTERANGE_H
@@ -0,0 +1,53 @@
+#ifndef EXPRESSIF_ETAG_H
+#define EXPRESSIF_ETAG_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+#include "../Buffer.h"
+
+namespace expressif::http::server {
+class ETag {
+public:
+    constexpr static uint64_t HashSeed = 0xcbf29ce484222325ULL;
+
+    /**
+     * Calculates 64-bit FNV-1a hash of the data. Can be used incrementally
+     * by passing the previous result as the seed.
+     * @param data The data to be hashed
+     * @param seed The initial value
+     * @return The hash
+     */
+    constexpr static uint64_t hash(ConstBuffer data, uint64_t seed = HashSeed) {
+        for (auto b : data) {
+            seed ^= static_cast<uint8_t>(b);
+            seed *= 0x100000001b3ULL;
+        }
+
+        return seed;
+    }
+
+    /**
+     * Creates an entity tag from the hash, e.g. `"00ab12cd34ef5678"`.
+     * @param hash The content hash
+     * @param weak If `true`, the weak tag will be created, i.e. `W/"..."`
+     * @return The quoted entity tag
+     */
+    static std::string make(uint64_t hash, bool weak = false);
+
+    /**
+     * Checks whether the `If-None-Match` header value matches the entity tag.
+     * Uses the weak comparison, as required for `If-None-Match`.
+     * @param header The header value, e.g. `"abc", W/"def"` or `*`
+     * @param etag The entity tag to compare with
+     * @return `true` if any of the listed tags matches
+     */
+    static bool matches(std::string_view header, std::string_view etag);
+
+private:
+    ETag() = default;
+};
+}
+
+#endif //EXPRESSIF_ETAG_H
@@ -0,0 +1,30 @@
+#ifndef EXPRESSIF_HTTPDATE_H
+#define EXPRESSIF_HTTPDATE_H
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <ctime>
+
+namespace expressif::http::server {
+/**
+ * Formats and parses HTTP dates (RFC 9110 IMF-fixdate),
+ * e.g. `Sun, 06 Nov 1994 08:49:37 GMT`
+ */
+class HTTPDate {
+public:
+    static std::string format(time_t time);
+
+    /**
+     * Parses the IMF-fixdate.
+     * @param date The date to be parsed
+     * @return The parsed time or `std::nullopt` if the date is malformed
+     */
+    static std::optional<time_t> parse(std::string_view date);
+
+private:
+    HTTPDate() = default;
+};
+}
+
+#endif //EXPRESSIF_HTTPDATE_H
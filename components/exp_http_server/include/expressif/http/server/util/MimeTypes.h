@@ -0,0 +1,79 @@
+#ifndef EXPRESSIF_MIMETYPES_H
+#define EXPRESSIF_MIMETYPES_H
+
+#include <array>
+#include <string_view>
+#include <utility>
+
+namespace expressif::http::server {
+/**
+ * The MIME types of the web assets. Constexpr, so the tables generated
+ * by `tools/embed_assets.py` use the same types, see EmbeddedAsset.
+ */
+class MimeTypes {
+public:
+    /**
+     * Guesses the MIME type by the file extension (case-insensitive).
+     * @param path The file path
+     * @return The MIME type, `application/octet-stream` if the extension is unknown
+     */
+    constexpr static std::string_view fromPath(std::string_view path) {
+        if (auto dot = path.find_last_of('.'); dot != std::string_view::npos) {
+            auto ext = path.substr(dot + 1);
+
+            for (auto &[key, type] : types) {
+                if (equalsIgnoreCase(key, ext)) {
+                    return type;
+                }
+            }
+        }
+
+        return "application/octet-stream";
+    }
+
+private:
+    MimeTypes() = default;
+
+    // the keys are lowercase
+    constexpr static bool equalsIgnoreCase(std::string_view key, std::string_view ext) {
+        if (key.size() != ext.size())
+            return false;
+
+        for (size_t i = 0; i < key.size(); ++i) {
+            auto c = ext[i];
+
+            if ((c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c) != key[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    constexpr static std::array<std::pair<std::string_view, std::string_view>, 20> types {{
+        {"html",  "text/html"},
+        {"htm",   "text/html"},
+        {"css",   "text/css"},
+        {"js",    "text/javascript"},
+        {"mjs",   "text/javascript"},
+        {"json",  "application/json"},
+        {"txt",   "text/plain"},
+        {"xml",   "application/xml"},
+        {"svg",   "image/svg+xml"},
+        {"png",   "image/png"},
+        {"jpg",   "image/jpeg"},
+        {"jpeg",  "image/jpeg"},
+        {"gif",   "image/gif"},
+        {"webp",  "image/webp"},
+        {"ico",   "image/x-icon"},
+        {"wasm",  "application/wasm"},
+        {"woff",  "font/woff"},
+        {"woff2", "font/woff2"},
+        {"pdf",   "application/pdf"},
+        {"bin",   "application/octet-stream"}
+    }};
+};
+}
+
+#endif //EXPRESSIF_MIMETYPES_H
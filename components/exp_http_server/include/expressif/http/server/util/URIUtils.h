@@ -4,11 +4,37 @@
 #include <cstddef>
 #include <sys/types.h>
 
+#include <memory_resource>
+#include <string>
 #include <string_view>
 
 namespace expressif::http::server {
 class URIUtils {
 public:
+    /**
+     * The sets of characters to be escaped, see URIUtils::encode(char*, std::string_view, EscapeMode)
+     */
+    enum class EscapeMode {
+        URI = 0,
+        Args,
+        URIComponent,
+        HTML, ///< for URIs embedded into HTML attributes, e.g. `href`
+        Refresh,
+        Memcached,
+        MailAuth
+    };
+
+public:
+    /**
+     * @brief Encode a string using the specified escape algorithm
+     *
+     * @param dest       a destination memory location, at least 3 times bigger than the source
+     * @param src        the source string
+     * @param mode       the escape algorithm
+     * @return uint32_t  the size of the encoded string
+     */
+    static uint32_t encode(char *dest, std::string_view src, EscapeMode mode);
+
     /**
      * @brief Encode an URI
      *
@@ -50,6 +76,15 @@ public:
      * @return A decoded string
      */
     static std::string decode(std::string_view src);
+
+    /**
+     * Decodes an URI into the string allocated from the specified resource.
+     * @see URIUtils::decode(std::string_view)
+     * @param src The source string
+     * @param resource The memory resource, e.g. the arena of the request
+     * @return A decoded string
+     */
+    static std::pmr::string decode(std::string_view src, std::pmr::memory_resource *resource);
 };
 }
 
@@ -0,0 +1,46 @@
+# the scripts are shipped with the component
+set(EXPRESSIF_TOOLS_DIR "${CMAKE_CURRENT_LIST_DIR}/tools")
+
+# Embeds the content of the directory into the firmware as a constexpr table
+# of expressif::http::server::EmbeddedAsset, which can be served by EmbeddedAssetHandler.
+#
+# expressif_embed_assets(<target> <assets dir> <header name>
+#                        [NAMESPACE <namespace>] [NAME <table name>])
+#
+# The header is generated into the binary dir of the target and is
+# regenerated each time the content of the directory changes, e.g.:
+#
+#   expressif_embed_assets(${COMPONENT_LIB} "${CMAKE_SOURCE_DIR}/data" "web_assets.h" NAMESPACE web)
+#   ...
+#   #include "web_assets.h"
+#   server.addEndpoint(HTTPMethod::Get, "/{file}*", EmbeddedAssetHandler(web::assets));
+function(expressif_embed_assets target assets_dir header)
+    cmake_parse_arguments(ARG "" "NAMESPACE;NAME" "" ${ARGN})
+
+    if (NOT ARG_NAMESPACE)
+        set(ARG_NAMESPACE "assets")
+    endif()
+
+    if (NOT ARG_NAME)
+        set(ARG_NAME "assets")
+    endif()
+
+    idf_build_get_property(python PYTHON)
+
+    set(out_dir "${CMAKE_CURRENT_BINARY_DIR}/embedded_assets")
+    set(script "${EXPRESSIF_TOOLS_DIR}/embed_assets.py")
+
+    file(GLOB_RECURSE asset_files CONFIGURE_DEPENDS "${assets_dir}/*")
+
+    add_custom_command(
+            OUTPUT "${out_dir}/${header}"
+            COMMAND ${python} ${script} ${assets_dir} "${out_dir}/${header}"
+                    --namespace ${ARG_NAMESPACE} --name ${ARG_NAME}
+            DEPENDS ${asset_files} ${script} "${EXPRESSIF_TOOLS_DIR}/compress_assets.py"
+            COMMENT "Embedding assets from ${assets_dir}"
+            VERBATIM)
+
+    add_custom_target(${target}_embedded_assets DEPENDS "${out_dir}/${header}")
+    add_dependencies(${target} ${target}_embedded_assets)
+    target_include_directories(${target} PRIVATE ${out_dir})
+endfunction()
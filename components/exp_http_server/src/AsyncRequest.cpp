@@ -0,0 +1,63 @@
+#include <expressif/http/server/AsyncRequest.h>
+#include <expressif/http/server/Request.h>
+
+#include "detail/RequestContext.h"
+
+#include <utility>
+
+namespace expressif::http::server {
+AsyncRequest::AsyncRequest()
+    : m_req(nullptr) {}
+
+AsyncRequest::AsyncRequest(
+    httpd_req_t *req,
+    std::unique_ptr<detail::RequestContext> context,
+    std::unique_ptr<Request> request
+) : m_req(req),
+    m_context(std::move(context)),
+    m_request(std::move(request)) {}
+
+AsyncRequest::AsyncRequest(AsyncRequest &&other) noexcept
+    : m_req(std::exchange(other.m_req, nullptr)),
+      m_context(std::move(other.m_context)),
+      m_request(std::move(other.m_request)) {}
+
+AsyncRequest& AsyncRequest::operator=(AsyncRequest &&other) noexcept {
+    if (this != &other) {
+        complete();
+        m_req = std::exchange(other.m_req, nullptr);
+        m_context = std::move(other.m_context);
+        m_request = std::move(other.m_request);
+    }
+
+    return *this;
+}
+
+AsyncRequest::~AsyncRequest() {
+    complete();
+}
+
+Request& AsyncRequest::request() {
+    return *m_request;
+}
+
+Response AsyncRequest::response() {
+    return m_request->response();
+}
+
+esp_err_t AsyncRequest::complete() {
+    if (!isValid())
+        return ESP_ERR_INVALID_STATE;
+
+    auto ret = httpd_req_async_handler_complete(std::exchange(m_req, nullptr));
+
+    m_request.reset();
+    m_context.reset();
+
+    return ret;
+}
+
+bool AsyncRequest::isValid() const {
+    return m_req != nullptr;
+}
+}
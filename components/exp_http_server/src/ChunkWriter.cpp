@@ -0,0 +1,134 @@
+#include <expressif/http/server/ChunkWriter.h>
+#include <expressif/http/server/util/URIUtils.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace expressif::http::server {
+ChunkWriter::ChunkWriter(Response response)
+    : m_response(response) {}
+
+ChunkWriter& ChunkWriter::write(std::string_view str) {
+    if (m_status != ESP_OK)
+        return *this;
+
+    if (str.size() <= m_buffer.size() - m_size) {
+        std::copy(str.begin(), str.end(), m_buffer.begin() + m_size);
+        m_size += str.size();
+        return *this;
+    }
+
+    if (flush() != ESP_OK)
+        return *this;
+
+    if (str.size() < m_buffer.size()) {
+        std::copy(str.begin(), str.end(), m_buffer.begin());
+        m_size = str.size();
+    } else {
+        m_status = m_response.writeChunk(toBuffer(str));
+    }
+
+    return *this;
+}
+
+ChunkWriter& ChunkWriter::write(char c) {
+    return write({&c, 1});
+}
+
+ChunkWriter& ChunkWriter::write(std::string_view str, Escape escape) {
+    switch (escape) {
+        case Escape::None: write(str); break;
+        case Escape::Html: writeHtml(str); break;
+        case Escape::Uri: writeUri(str); break;
+        case Escape::Json: writeJson(str); break;
+    }
+
+    return *this;
+}
+
+esp_err_t ChunkWriter::flush() {
+    if (m_status == ESP_OK && m_size > 0) {
+        m_status = m_response.writeChunk(toBuffer(std::string_view {m_buffer.data(), m_size}));
+        m_size = 0;
+    }
+
+    return m_status;
+}
+
+esp_err_t ChunkWriter::finish() {
+    if (flush() == ESP_OK)
+        m_status = m_response.flush();
+
+    return m_status;
+}
+
+esp_err_t ChunkWriter::getStatus() const {
+    return m_status;
+}
+
+Response& ChunkWriter::getResponse() {
+    return m_response;
+}
+
+// writes the runs of the characters that need no escaping at once
+template<typename F>
+static void escape(ChunkWriter &writer, std::string_view str, F &&replacement) {
+    size_t begin = 0;
+
+    for (size_t i = 0; i < str.size(); ++i) {
+        if (auto replaced = replacement(str[i]); !replaced.empty()) {
+            writer.write(str.substr(begin, i - begin));
+            writer.write(replaced);
+            begin = i + 1;
+        }
+    }
+
+    writer.write(str.substr(begin));
+}
+
+void ChunkWriter::writeHtml(std::string_view str) {
+    escape(*this, str, [](char c) -> std::string_view {
+        switch (c) {
+            case '&': return "&amp;";
+            case '<': return "&lt;";
+            case '>': return "&gt;";
+            case '"': return "&quot;";
+            case '\'': return "&#39;";
+            default: return {};
+        }
+    });
+}
+
+void ChunkWriter::writeJson(std::string_view str) {
+    char hex[7] {};
+
+    escape(*this, str, [&hex](char c) -> std::string_view {
+        switch (c) {
+            case '"': return "\\\"";
+            case '\\': return "\\\\";
+            case '\n': return "\\n";
+            case '\r': return "\\r";
+            case '\t': return "\\t";
+            default: break;
+        }
+
+        if (static_cast<unsigned char>(c) < 0x20) {
+            snprintf(hex, sizeof(hex), "\\u%04x", c);
+            return hex;
+        }
+
+        return {};
+    });
+}
+
+void ChunkWriter::writeUri(std::string_view str) {
+    // the encoded string is at most 3 times bigger
+    constexpr size_t pieceSize = 32;
+    char encoded[pieceSize * 3];
+
+    for (size_t i = 0; i < str.size(); i += pieceSize) {
+        auto size = URIUtils::encode(encoded, str.substr(i, pieceSize), URIUtils::EscapeMode::HTML);
+        write({encoded, size});
+    }
+}
+}
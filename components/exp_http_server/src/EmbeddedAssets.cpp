@@ -0,0 +1,67 @@
+#include <expressif/http/server/EmbeddedAssets.h>
+#include <expressif/http/server/util/AcceptEncoding.h>
+
+#include <algorithm>
+
+namespace expressif::http::server {
+EmbeddedAssetHandler::EmbeddedAssetHandler(
+    std::span<const EmbeddedAsset> assets,
+    std::string_view pathVar,
+    std::string_view indexFile
+) : m_assets(assets),
+    m_pathVar(pathVar),
+    m_indexFile(indexFile) {}
+
+const EmbeddedAsset* EmbeddedAssetHandler::find(std::string_view path, std::string_view acceptEncoding) const {
+    auto range = std::ranges::equal_range(m_assets, EmbeddedAsset::hashPath(path), {}, &EmbeddedAsset::pathHash);
+
+    for (auto &asset : range) {
+        if (asset.path != path)
+            continue;
+
+        if (asset.encoding.empty() || AcceptEncoding::isAccepted(acceptEncoding, asset.encoding)) {
+            return &asset;
+        }
+    }
+
+    return nullptr;
+}
+
+HandlerResult EmbeddedAssetHandler::operator()(Request &req) const {
+    std::string_view path;
+
+    if (req.hasPathVar(m_pathVar))
+        path = req.getPathVar(m_pathVar);
+
+    if (path.empty())
+        path = m_indexFile;
+
+    auto asset = find(path, req.getHeader("Accept-Encoding", req.getArena()));
+
+    if (asset == nullptr) {
+        req.response().error404();
+        return HandlerResult::Keep;
+    }
+
+    auto resp = req.response();
+    resp.setHeader("Vary", "Accept-Encoding");
+
+    Validators validators {std::string {asset->etag}};
+
+    if (req.checkNotModified(validators))
+        return HandlerResult::Keep;
+
+    // the strings are generated as literals, i.e. they are null-terminated
+    resp.setType(asset->type);
+
+    if (!asset->encoding.empty())
+        resp.setHeader("Content-Encoding", asset->encoding);
+
+    // sent directly from the memory-mapped flash
+    auto ret = resp.writeRanges(asset->data.size(), validators, [&](size_t offset, size_t length) {
+        return resp.writeChunk(asset->data.subspan(offset, length));
+    });
+
+    return ret == ESP_OK ? HandlerResult::Keep : HandlerResult::Discard;
+}
+}
@@ -0,0 +1,117 @@
+#include <expressif/http/server/EventSource.h>
+
+#include <esp_log.h>
+
+#include "detail/RequestContext.h"
+#include "detail/ResponseWriter.h"
+#include "detail/SessionManager.h"
+#include "detail/SessionQueues.h"
+#include "detail/StringUtils.h"
+#include "sdkconfig.h"
+
+namespace expressif::http::server {
+constexpr static auto TAG = "expressif::http::server::EventSource";
+
+EventSource::EventSource()
+    : m_sessions(std::make_shared<detail::SessionQueues>(CONFIG_HTTP_SERVER_SSE_QUEUE_SIZE)) {}
+
+bool EventSource::send(ClientId client, std::string_view data, std::string_view event, std::string_view id) {
+    return m_sessions->push(client, format(data, event, id));
+}
+
+size_t EventSource::broadcast(std::string_view data, std::string_view event, std::string_view id) {
+    // formatted once, shared by all queues
+    return m_sessions->pushAll(format(data, event, id));
+}
+
+size_t EventSource::getClientCount() const {
+    return m_sessions->size();
+}
+
+void EventSource::setOnOpen(OpenHandler handler) {
+    m_onOpen = std::move(handler);
+}
+
+void EventSource::setOnClose(CloseHandler handler) {
+    m_onClose = std::move(handler);
+}
+
+esp_err_t EventSource::open(Request &req) {
+    auto resp = req.response();
+    resp.setType("text/event-stream");
+    resp.setHeader("Cache-Control", "no-cache");
+
+    // the events are not requests: the connection is neither idle,
+    // nor closed after its last request, see SessionConfig
+    if (auto session = req.getSession()) {
+        session->setIdleTimeout(std::chrono::milliseconds(0));
+        detail::SessionManager::keepOpen(*session);
+
+        // set by HTTPServer::beginRequest for the last request
+        std::erase_if(detail::RequestContext::of(req.m_req)->headers, [](const auto &header) {
+            return detail::equalsIgnoreCase(header.first, "Connection");
+        });
+    }
+
+    // the stream has no length, the events are sent as is
+    if (auto ret = detail::sendHead(req.m_req, detail::Framing::None); ret != ESP_OK)
+        return ret;
+
+    auto id = httpd_req_to_sockfd(req.m_req);
+
+    m_sessions->add(req.m_req->handle, id);
+
+    ESP_LOGD(TAG, "Client %i connected", id);
+
+    if (m_onOpen)
+        m_onOpen(req, id);
+
+    return ESP_OK;
+}
+
+void EventSource::close(ClientId client) {
+    if (!m_sessions->remove(client))
+        return;
+
+    ESP_LOGD(TAG, "Client %i disconnected", client);
+
+    if (m_onClose) {
+        m_onClose(client);
+    }
+}
+
+void EventSource::closeAll(httpd_handle_t handle) {
+    for (auto client : m_sessions->getSockets()) {
+        httpd_sess_trigger_close(handle, client);
+        close(client);
+    }
+}
+
+std::shared_ptr<const std::string> EventSource::format(
+    std::string_view data, std::string_view event, std::string_view id
+) {
+    auto result = std::make_shared<std::string>();
+    result->reserve(data.size() + event.size() + id.size() + 24);
+
+    if (!id.empty())
+        result->append("id: ").append(id).append("\n");
+
+    if (!event.empty())
+        result->append("event: ").append(event).append("\n");
+
+    // each line of the data must be prefixed
+    while (true) {
+        auto end = data.find('\n');
+        result->append("data: ").append(data.substr(0, end)).append("\n");
+
+        if (end == std::string_view::npos)
+            break;
+
+        data.remove_prefix(end + 1);
+    }
+
+    result->append("\n");
+
+    return result;
+}
+}
@@ -1,41 +1,316 @@
 #include <expressif/http/server/HTTPServer.h>
 #include <expressif/http/server/util/URIPathParser.h>
 
+#include "detail/CoroutineScheduler.h"
 #include "detail/EndpointData.h"
+#include "detail/LoadMonitor.h"
+#include "detail/Metrics.h"
+#include "detail/RateLimiter.h"
+#include "detail/RequestContext.h"
+#include "detail/ResponseCache.h"
+#include "detail/ResponseWriter.h"
+#include "detail/SessionManager.h"
+#include "detail/SocketTuning.h"
+#include "detail/Tracer.h"
+#include "detail/WorkerPool.h"
 
 #include <algorithm>
+#include <charconv>
+#include <optional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <unistd.h>
 
 namespace expressif::http::server {
 constexpr static auto TAG = "expressif::http::server::HTTPServer";
 
 HTTPServer::HTTPServer()
-    : m_server() {}
+    : m_server(),
+      m_sessions(std::make_unique<detail::SessionManager>())
+{
+#if CONFIG_HTTP_SERVER_METRICS
+    m_metrics = std::make_unique<detail::ServerMetrics>();
+#endif
+}
 
 HTTPServer::~HTTPServer() {
+    // nothing is dispatched to the pool and the coroutines anymore,
+    // the queued requests are served first
+    rejectRequests();
+    m_workers.reset();
+    m_coroutines.reset();
     stop();
 }
 
+void HTTPServer::rejectRequests() {
+    if (!isValid()) {
+        m_isStopping = true;
+        return;
+    }
+
+    struct Work {
+        HTTPServer *server;
+        SemaphoreHandle_t done;
+    } work {this, xSemaphoreCreateBinary()};
+
+    // the work runs between the requests, i.e. not during dispatch
+    auto ret = work.done != nullptr ? httpd_queue_work(m_server, [](void *arg) {
+        auto work = static_cast<Work*>(arg);
+        work->server->m_isStopping = true;
+        xSemaphoreGive(work->done);
+    }, &work) : ESP_ERR_NO_MEM;
+
+    if (ret == ESP_OK) {
+        xSemaphoreTake(work.done, portMAX_DELAY);
+    } else {
+        ESP_LOGE(TAG, "Cannot stop dispatching the requests: %s", esp_err_to_name(ret));
+        stop();
+    }
+
+    if (work.done != nullptr) {
+        vSemaphoreDelete(work.done);
+    }
+}
+
 decltype(HTTPServer::m_endpoints)::iterator HTTPServer::findEndpointData(HTTPMethod method, std::string_view uri) {
-    return std::ranges::find_if(m_endpoints, [=](const detail::EndpointData &data) {
-        return data.method == method && URIPathParser::isMatches(data.uriTemplate, uri);
+    return std::ranges::find_if(m_endpoints, [=](const auto &data) {
+        return data->method == method && URIPathParser::isMatches(data->uriTemplate, uri);
+    });
+}
+
+constexpr static auto ServiceUnavailableStatus = "503 Service Unavailable";
+
+// preformatted: sent under load, when the server can least afford composing it
+constexpr static std::string_view ServiceUnavailable =
+    "HTTP/1.1 503 Service Unavailable\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 19\r\n"
+    "Retry-After: 1\r\n"
+    "\r\n"
+    "Service Unavailable";
+
+static esp_err_t sendServiceUnavailable(httpd_req_t *nativeRequest, Request &request) {
+    auto context = detail::RequestContext::of(nativeRequest);
+
+    // e.g. Connection: close, see HTTPServer::beginRequest
+    if (context == nullptr || !context->headers.empty()) {
+        auto resp = request.response();
+        resp.setStatus(ServiceUnavailableStatus);
+        resp.setHeader("Retry-After", "1");
+        return resp.writeAll(toBuffer("Service Unavailable"));
+    }
+
+    context->status = ServiceUnavailableStatus;
+    context->isHeadSent = true;
+
+    return detail::sendAll(nativeRequest, toBuffer(ServiceUnavailable));
+}
+
+// the value of Retry-After is stored in the arena, so it lives until the response is sent
+static esp_err_t sendTooManyRequests(Request &request, detail::RequestContext &context, uint32_t wait) {
+    char seconds[12];
+    auto end = std::to_chars(seconds, std::end(seconds), std::max<uint32_t>((wait + 999999) / 1000000, 1)).ptr;
+
+    auto resp = request.response();
+    resp.setStatus("429 Too Many Requests");
+    resp.setHeader("Retry-After", context.store({seconds, end}));
+    return resp.writeAll(toBuffer("Too Many Requests"));
+}
+
+// sends the cached response instead of calling the handler
+static esp_err_t sendCached(Request &request, const detail::ResponseCache::Entry &entry) {
+    auto resp = request.response();
+
+    for (auto &[name, value] : entry.headers)
+        resp.setHeader(name, value);
+
+    // the validators are among the headers of the entry
+    if (request.isNotModified(entry.validators))
+        return resp.notModified({});
+
+    resp.setType(entry.type);
+
+    ConstBuffer body {entry.body.data(), entry.body.size()};
+
+    if (entry.compressionMinSize != 0 && resp.enableCompression(entry.compressionMinSize) == ESP_OK)
+        return resp.writeAll(body);
+
+    return resp.writeRanges(body.size(), entry.validators, [&](size_t offset, size_t length) {
+        return resp.writeChunk(body.subspan(offset, length));
     });
 }
 
+esp_err_t HTTPServer::invokeHandler(
+    Request &request, detail::EndpointData &endpoint,
+    std::string &cacheKey, detail::RequestContext &context
+) {
+    // the coroutines are traced until the first suspension
+    detail::TraceSpan span(context.span, detail::TracePhase::Handler);
+
+    if (endpoint.coroutineHandler)
+        return m_coroutines->spawn(request, endpoint.coroutineHandler) ? ESP_OK : ESP_FAIL;
+
+#if CONFIG_HTTP_SERVER_METRICS
+    std::optional<detail::ResourceProbe> probe;
+
+    if (endpoint.options.trackResources)
+        probe.emplace();
+#endif
+
+    auto result = endpoint.handler(request);
+
+#if CONFIG_HTTP_SERVER_METRICS
+    if (probe.has_value())
+        probe->record(*endpoint.metrics);
+#endif
+
+    span.end();
+
+    if (result != HandlerResult::Keep)
+        return ESP_FAIL;
+
+    if (!cacheKey.empty())
+        m_cache->store(std::move(cacheKey), endpoint.uriTemplate, *endpoint.options.cache, context);
+
+    return ESP_OK;
+}
+
+bool HTTPServer::isOffloaded(const detail::EndpointData &endpoint) const {
+    return m_workers && endpoint.options.offload.value_or(m_isOffloadedByDefault);
+}
+
+esp_err_t HTTPServer::dispatch(
+    httpd_req_t *nativeRequest, Request &request,
+    detail::EndpointData &endpoint, detail::RequestContext &context
+) {
+    // the pool and the coroutines are being destroyed
+    if (m_isStopping)
+        return sendServiceUnavailable(nativeRequest, request);
+
+    auto &cachePolicy = endpoint.options.cache;
+
+    std::string cacheKey;
+
+    if (cachePolicy.has_value() && nativeRequest->method == HTTP_GET && m_cache) {
+        cacheKey = detail::ResponseCache::makeKey(nativeRequest, *cachePolicy);
+
+        // keeps the entry alive even if it gets evicted meanwhile
+        if (auto entry = m_cache->find(cacheKey))
+            return sendCached(request, *entry) == ESP_OK ? ESP_OK : ESP_FAIL;
+
+        context.capture = std::make_unique<detail::ResponseCapture>(m_cache->getMaxEntrySize());
+    }
+
+    if (isOffloaded(endpoint)) {
+        if (!m_workers->hasCapacity())
+            return sendServiceUnavailable(nativeRequest, request);
+
+        // if the request cannot be detached, it is handled in place
+        if (auto async = request.detach(); async.isValid()) {
+            detail::Job job {std::move(async), endpoint.shared_from_this(), std::move(cacheKey), esp_timer_get_time()};
+
+            // the job is returned if the queue is full, the request is already detached
+            if (!m_workers->submit(std::move(job))) {
+                ESP_LOGW(TAG, "The worker queue is full");
+                sendServiceUnavailable(job.request.m_req, job.request.request());
+                return job.request.complete();
+            }
+
+            return ESP_OK;
+        }
+    }
+
+    // ok, handle request
+    return invokeHandler(request, endpoint, cacheKey, context);
+}
+
 esp_err_t HTTPServer::requestHandler(httpd_req_t *nativeRequest) {
+#if CONFIG_HTTP_SERVER_METRICS
+    auto startTime = esp_timer_get_time();
+#endif
+
     auto server = static_cast<HTTPServer*>(httpd_get_global_user_ctx(nativeRequest->handle));
+
+    detail::RequestContext context;
+    nativeRequest->user_ctx = &context;
+
+#if CONFIG_HTTP_SERVER_TRACING
+    context.span = detail::TraceSpan(httpd_req_to_sockfd(nativeRequest));
+#endif
+
+    detail::TraceSpan routing(context.span, detail::TracePhase::Routing);
     auto dataIt = server->findEndpointData(static_cast<HTTPMethod>(nativeRequest->method), nativeRequest->uri);
+    routing.end();
+
+    auto endpoint = dataIt != server->m_endpoints.end() ? dataIt->get() : nullptr;
+    context.endpoint = endpoint;
 
     Request request(nativeRequest);
+    server->beginRequest(nativeRequest, request, context);
 
-    if (dataIt != server->m_endpoints.end()) {
-        // ok, handle request
-        nativeRequest->user_ctx = dataIt.base();
-        return dataIt->handler(request) == HandlerResult::Keep ? ESP_OK : ESP_FAIL;
+    // identifies the client, the address is looked up once per connection
+    auto getClientKey = [&] {
+        auto session = context.session.get();
+
+        if (session == nullptr)
+            return detail::RateLimiter::getClientKey(httpd_req_to_sockfd(nativeRequest));
+
+        if (session->m_clientKey == 0)
+            session->m_clientKey = detail::RateLimiter::getClientKey(session->m_socket);
+
+        return session->m_clientKey;
+    };
+
+    if (endpoint != nullptr) {
+#if CONFIG_HTTP_SERVER_METRICS
+        // recorded when the context is destroyed, i.e. when the request ends
+        context.metrics = endpoint->metrics;
+        context.startTime = startTime;
+        context.bytesIn = nativeRequest->content_len;
+#endif
+
+        for (auto limiter : {server->m_rateLimiter.get(), endpoint->rateLimiter.get()}) {
+            if (auto wait = limiter != nullptr ? limiter->acquire(getClientKey()) : 0; wait != 0) {
+                return sendTooManyRequests(request, context, wait);
+            }
+        }
+
+        if (server->m_loadMonitor && endpoint->options.priority != LoadPriority::Critical) {
+            if (server->m_loadMonitor->isOverloaded(server->m_workers.get())) {
+                return sendServiceUnavailable(nativeRequest, request);
+            }
+        }
+
+        if (server->m_middleware.empty())
+            return server->dispatch(nativeRequest, request, *endpoint, context);
+
+        // the endpoint is dispatched after the last middleware
+        auto dispatch = [&] {
+            auto ret = server->dispatch(nativeRequest, request, *endpoint, context);
+            return ret == ESP_OK ? HandlerResult::Keep : HandlerResult::Discard;
+        };
+
+        Next next(request, server->m_middleware, [](void *arg) {
+            return (*static_cast<decltype(dispatch)*>(arg))();
+        }, &dispatch);
+
+        return next() == HandlerResult::Keep ? ESP_OK : ESP_FAIL;
     } else {
+        if (auto wait = server->m_rateLimiter ? server->m_rateLimiter->acquire(getClientKey()) : 0; wait != 0)
+            return sendTooManyRequests(request, context, wait);
+
         // error, 404
         auto it404 = server->findErrorHandler(HTTPD_404_NOT_FOUND);
 
+#if CONFIG_HTTP_SERVER_METRICS
+        server->m_metrics->notFound.fetch_add(1, std::memory_order_relaxed);
+
+        if (it404 != server->m_errorHandlers.end())
+            server->m_metrics->errorHandlerCalls.fetch_add(1, std::memory_order_relaxed);
+#endif
+
         if (it404 != server->m_errorHandlers.end()) {
             return it404->second(request, HTTPD_404_NOT_FOUND) == HandlerResult::Keep ? ESP_OK : ESP_FAIL;
         } else {
@@ -44,36 +319,156 @@ esp_err_t HTTPServer::requestHandler(httpd_req_t *nativeRequest) {
     }
 }
 
+void HTTPServer::beginRequest(httpd_req_t *nativeRequest, Request &request, detail::RequestContext &context) {
+    auto session = Session::of(nativeRequest);
+
+    if (session == nullptr)
+        return;
+
+    // esp_http_server does not close the connection by itself
+    if (m_sessions->beginRequest(*session))
+        request.response().setHeader("Connection", "close");
+
+    context.session.reset(session);
+}
+
+esp_err_t HTTPServer::openHandler(httpd_handle_t handle, int sockfd) {
+    auto server = static_cast<HTTPServer*>(httpd_get_global_user_ctx(handle));
+
+    detail::applySocketOptions(sockfd, server->m_socketOptions);
+
+    if (server->m_openFn) {
+        if (auto ret = server->m_openFn(handle, sockfd); ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    auto &session = server->m_sessions->open(handle, sockfd);
+
+    if (server->m_onSessionOpen)
+        server->m_onSessionOpen(session);
+
+    return ESP_OK;
+}
+
+void HTTPServer::closeHandler(httpd_handle_t handle, int sockfd) {
+    auto server = static_cast<HTTPServer*>(httpd_get_global_user_ctx(handle));
+
+    // freed by esp_http_server after the socket is closed;
+    // not created if the connection has been rejected by open_fn
+    if (auto session = static_cast<Session*>(httpd_sess_get_ctx(handle, sockfd))) {
+        if (server->m_onSessionClose)
+            server->m_onSessionClose(*session);
+
+        server->m_sessions->close(*session);
+    }
+
+    // copied, the handlers of the event sources may add or remove the endpoints
+    std::vector<std::shared_ptr<EventSource>> sources;
+
+    {
+        std::lock_guard lock(server->m_eventSourcesMutex);
+
+        for (auto &[uriTemplate, source] : server->m_eventSources) {
+            sources.emplace_back(source);
+        }
+    }
+
+    for (auto &source : sources)
+        source->close(sockfd);
+
+    for (auto &webSocket : server->m_webSockets)
+        webSocket->close(sockfd);
+
+    if (server->m_closeFn) {
+        server->m_closeFn(handle, sockfd);
+    } else {
+        close(sockfd);
+    }
+}
+
+// the catch-all handlers match any URI, the WebSocket ones only their templates
+bool HTTPServer::matchUri(const char *reference, const char *uri, size_t length) {
+    std::string_view referenceView = reference;
+
+    if (referenceView.starts_with(WebSocket::UriPrefix)) {
+        referenceView.remove_prefix(WebSocket::UriPrefix.size());
+        return URIPathParser::isMatches(referenceView, {uri, length});
+    }
+
+    return true;
+}
+
 esp_err_t HTTPServer::start(HTTPServer::Config config) {
-    config.uri_match_fn = [](auto, auto, auto) { return true; };
+    config.uri_match_fn = matchUri;
     config.global_user_ctx = this;
 
+    // otherwise httpd_stop frees the context, i.e. this object
+    config.global_user_ctx_free_fn = [](void*) {};
+
+    m_openFn = config.open_fn;
+    config.open_fn = openHandler;
+
+    m_closeFn = config.close_fn;
+    config.close_fn = closeHandler;
+
     if (auto ret = httpd_start(&m_server, &config); ret != ESP_OK)
         return ret;
 
-    auto mkMethodHandler = [](HTTPMethod method) {
-        return httpd_uri_t {
+    if (auto ret = registerUriHandlers(); ret != ESP_OK) {
+        stop();
+        return ret;
+    }
+
+    if (auto ret = m_sessions->start(m_server, config.max_open_sockets, config.lru_purge_enable); ret != ESP_OK) {
+        stop();
+        return ret;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t HTTPServer::registerUriHandlers() {
+    constexpr HTTPMethod methods[] {HTTPMethod::Get, HTTPMethod::Post, HTTPMethod::Put, HTTPMethod::Delete};
+
+    // esp_http_server matches the handlers in the order of registration, and the
+    // free slots are reused: re-register everything, the catch-all handlers last
+    for (auto method : methods)
+        httpd_unregister_uri_handler(m_server, "", static_cast<httpd_method_t>(method));
+
+#if CONFIG_HTTPD_WS_SUPPORT
+    for (auto &webSocket : m_webSockets)
+        httpd_unregister_uri_handler(m_server, webSocket->getUri(), HTTP_GET);
+
+    for (auto &webSocket : m_webSockets) {
+        httpd_uri_t handler {
+            .uri                    = webSocket->getUri(),
+            .method                 = HTTP_GET,
+            .handler                = WebSocket::handler,
+            .user_ctx               = webSocket.get(),
+            .is_websocket           = true,
+            .handle_ws_control_frames = false,
+            .supported_subprotocol  = nullptr
+        };
+
+        if (auto ret = httpd_register_uri_handler(m_server, &handler); ret != ESP_OK) {
+            return ret;
+        }
+    }
+#endif
+
+    for (auto method : methods) {
+        httpd_uri_t handler {
             .uri       = "",
             .method    = static_cast<httpd_method_t>(method),
             .handler   = HTTPServer::requestHandler,
             .user_ctx  = nullptr
         };
-    };
-
-    auto getHandler = mkMethodHandler(HTTPMethod::Get);
-    auto postHandler = mkMethodHandler(HTTPMethod::Post);
-    auto putHandler = mkMethodHandler(HTTPMethod::Put);
-    auto deleteHandler = mkMethodHandler(HTTPMethod::Delete);
 
-#define registerUriHandler(handler) \
-    if (auto ret = httpd_register_uri_handler(m_server, &handler); ret != ESP_OK) { stop(); return ret; }
-
-    registerUriHandler(getHandler)
-    registerUriHandler(postHandler)
-    registerUriHandler(putHandler)
-    registerUriHandler(deleteHandler)
-
-#undef registerUriHandler
+        if (auto ret = httpd_register_uri_handler(m_server, &handler); ret != ESP_OK) {
+            return ret;
+        }
+    }
 
     return ESP_OK;
 }
@@ -82,6 +477,8 @@ bool HTTPServer::stop() {
     if (!isValid())
         return false;
 
+    m_sessions->stop();
+
     httpd_stop(m_server);
     m_server = nullptr;
 
@@ -91,36 +488,222 @@ bool HTTPServer::stop() {
 bool HTTPServer::addEndpoint(
     HTTPMethod method,
     std::string_view uriTemplate,
-    EndpointHandler handler
+    EndpointHandler handler,
+    EndpointOptions options
 ) {
-    detail::EndpointData data {method, uriTemplate.data(), std::move(handler)};
+    if (options.cache.has_value() && !m_cache) {
+        m_cache = std::make_unique<detail::ResponseCache>(
+            CONFIG_HTTP_SERVER_CACHE_SIZE, CONFIG_HTTP_SERVER_CACHE_MAX_ENTRY_SIZE);
+    }
+
+    return insertEndpoint({method, uriTemplate.data(), std::move(handler), std::move(options)});
+}
+
+bool HTTPServer::insertEndpoint(detail::EndpointData &&data) {
+    // the new endpoint may shadow the cached ones
+    invalidateCache();
+
+    auto endpoint = std::make_shared<detail::EndpointData>(std::move(data));
+
+    if (endpoint->options.rateLimit.has_value())
+        endpoint->rateLimiter = std::make_unique<detail::RateLimiter>(*endpoint->options.rateLimit);
+
+#if CONFIG_HTTP_SERVER_METRICS
+    endpoint->metrics = std::make_shared<detail::EndpointMetrics>();
+#endif
 
     // O(log(n))
-    auto index = std::ranges::upper_bound(m_endpoints, data, [](const auto &d1, const auto &d2) {
-        return d1.priority > d2.priority;
+    auto index = std::ranges::upper_bound(m_endpoints, endpoint, [](const auto &d1, const auto &d2) {
+        return d1->priority > d2->priority;
     });
 
-    // O(n)
-    auto &inserted = *m_endpoints.insert(index, std::move(data));
-
     ESP_LOGD(TAG, "New endpoint: template = %s, priority: %i",
-             inserted.uriTemplate.c_str(), inserted.priority);
+             endpoint->uriTemplate.c_str(), endpoint->priority);
+
+    // O(n)
+    m_endpoints.insert(index, std::move(endpoint));
 
     return true;
 }
 
+bool HTTPServer::addCoroutineEndpoint(
+    HTTPMethod method,
+    std::string_view uriTemplate,
+    CoroutineHandler handler,
+    EndpointOptions options
+) {
+    if (!m_coroutines) {
+        auto coroutines = std::make_unique<detail::CoroutineScheduler>();
+
+        if (!coroutines->isValid())
+            return false;
+
+        m_coroutines = std::move(coroutines);
+    }
+
+    // the coroutines do not block the server task, the responses are
+    // sent after the handler returns, so they cannot be captured
+    options.offload = false;
+    options.cache.reset();
+
+    return insertEndpoint({method, uriTemplate.data(), std::move(handler), std::move(options)});
+}
+
+void HTTPServer::use(Middleware middleware) {
+    m_middleware.emplace_back(std::move(middleware));
+}
+
 bool HTTPServer::removeEndpoint(HTTPMethod method, std::string_view uriTemplate) {
-    auto endpointByNamePred = [=](const detail::EndpointData &data) {
-        return data.method == method && data.uriTemplate == uriTemplate;
+    auto endpointByNamePred = [=](const auto &data) {
+        return data->method == method && data->uriTemplate == uriTemplate;
     };
 
     // delete the corresponding endpoint
-    if (auto it = std::ranges::find_if(m_endpoints, endpointByNamePred); it != m_endpoints.end()) {
-        m_endpoints.erase(it);
-        return true;
+    auto it = std::ranges::find_if(m_endpoints, endpointByNamePred);
+
+    if (it == m_endpoints.end())
+        return false;
+
+    m_endpoints.erase(it);
+    invalidateCache();
+
+    if (method == HTTPMethod::Get)
+        removeEventSource(uriTemplate);
+
+    return true;
+}
+
+void HTTPServer::removeEventSource(std::string_view uriTemplate) {
+    std::shared_ptr<EventSource> source;
+
+    {
+        std::lock_guard lock(m_eventSourcesMutex);
+
+        auto it = std::ranges::find(m_eventSources, uriTemplate, [](const auto &entry) {
+            return std::string_view(entry.first);
+        });
+
+        if (it == m_eventSources.end())
+            return;
+
+        source = std::move(it->second);
+        m_eventSources.erase(it);
     }
 
+    // the clients are no longer notified by closeHandler
+    if (isValid()) {
+        source->closeAll(m_server);
+    }
+}
+
+void HTTPServer::invalidateCache() {
+    if (m_cache) {
+        m_cache->clear();
+    }
+}
+
+void HTTPServer::invalidateCache(std::string_view uriTemplate) {
+    if (m_cache) {
+        m_cache->invalidate(uriTemplate);
+    }
+}
+
+esp_err_t HTTPServer::startWorkerPool(const WorkerPoolConfig &config, bool isOffloadedByDefault) {
+    if (m_workers || isValid())
+        return ESP_ERR_INVALID_STATE;
+
+    auto workers = std::make_unique<detail::WorkerPool>(config, [this](detail::Job &job) {
+        auto req = job.request.m_req;
+        auto context = detail::RequestContext::of(req);
+
+        if (m_loadMonitor)
+            m_loadMonitor->recordQueueWait(esp_timer_get_time() - job.submitTime);
+
+        if (invokeHandler(job.request.request(), *job.endpoint, job.cacheKey, *context) != ESP_OK) {
+            // the same as returning ESP_FAIL from the handler in the server task
+            httpd_sess_trigger_close(req->handle, httpd_req_to_sockfd(req));
+        }
+    });
+
+    if (!workers->isValid())
+        return ESP_ERR_NO_MEM;
+
+    m_workers = std::move(workers);
+    m_isOffloadedByDefault = isOffloadedByDefault;
+
+    return ESP_OK;
+}
+
+esp_err_t HTTPServer::writeMetrics(Response response) const {
+#if CONFIG_HTTP_SERVER_METRICS
+    return detail::writeMetrics(response, m_endpoints, *m_metrics, getSessionStats());
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool HTTPServer::addMetricsEndpoint(std::string_view uriTemplate) {
+    return addEndpoint(HTTPMethod::Get, uriTemplate, [this](Request &req) {
+        return writeMetrics(req.response()) == ESP_OK ? HandlerResult::Keep : HandlerResult::Discard;
+    });
+}
+
+esp_err_t HTTPServer::writeTrace(Response response) const {
+#if CONFIG_HTTP_SERVER_TRACING
+    return detail::writeTrace(response);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool HTTPServer::addTraceEndpoint(std::string_view uriTemplate) {
+#if CONFIG_HTTP_SERVER_TRACING
+    return addEndpoint(HTTPMethod::Get, uriTemplate, [this](Request &req) {
+        return writeTrace(req.response()) == ESP_OK ? HandlerResult::Keep : HandlerResult::Discard;
+    });
+#else
+    ESP_LOGE(TAG, "The trace endpoint requires CONFIG_HTTP_SERVER_TRACING");
     return false;
+#endif
+}
+
+std::shared_ptr<EventSource> HTTPServer::addEventSource(std::string_view uriTemplate) {
+    std::shared_ptr<EventSource> source(new EventSource());
+
+    auto added = addEndpoint(HTTPMethod::Get, uriTemplate, [source](Request &req) {
+        return source->open(req) == ESP_OK ? HandlerResult::Keep : HandlerResult::Discard;
+    });
+
+    if (!added)
+        return nullptr;
+
+    std::lock_guard lock(m_eventSourcesMutex);
+    m_eventSources.emplace_back(uriTemplate, source);
+
+    return source;
+}
+
+std::shared_ptr<WebSocket> HTTPServer::addWebSocketEndpoint(std::string_view uriTemplate, WebSocket::Handlers handlers) {
+#if CONFIG_HTTPD_WS_SUPPORT
+    std::shared_ptr<WebSocket> webSocket(new WebSocket(uriTemplate, std::move(handlers)));
+
+    m_webSockets.emplace_back(webSocket);
+
+    if (isValid()) {
+        if (auto ret = registerUriHandlers(); ret != ESP_OK) {
+            ESP_LOGE(TAG, "Cannot register the WebSocket endpoint %s: %s",
+                     webSocket->getUri(), esp_err_to_name(ret));
+            m_webSockets.pop_back();
+            registerUriHandlers();
+            return nullptr;
+        }
+    }
+
+    return webSocket;
+#else
+    ESP_LOGE(TAG, "WebSocket endpoints require CONFIG_HTTPD_WS_SUPPORT");
+    return nullptr;
+#endif
 }
 
 decltype(HTTPServer::m_errorHandlers)::iterator HTTPServer::findErrorHandler(httpd_err_code_t error) {
@@ -129,11 +712,74 @@ decltype(HTTPServer::m_errorHandlers)::iterator HTTPServer::findErrorHandler(htt
     });
 }
 
+bool HTTPServer::setRateLimit(const RateLimit &limit) {
+    if (isValid())
+        return false;
+
+    m_rateLimiter = std::make_unique<detail::RateLimiter>(limit);
+
+    return true;
+}
+
+bool HTTPServer::removeRateLimit() {
+    if (isValid())
+        return false;
+
+    m_rateLimiter.reset();
+
+    return true;
+}
+
+bool HTTPServer::setLoadShedding(const LoadSheddingConfig &config) {
+    if (isValid())
+        return false;
+
+    m_loadMonitor = std::make_unique<detail::LoadMonitor>(config);
+
+    return true;
+}
+
+bool HTTPServer::removeLoadShedding() {
+    if (isValid())
+        return false;
+
+    m_loadMonitor.reset();
+
+    return true;
+}
+
+void HTTPServer::setSessionConfig(const SessionConfig &config) {
+    m_sessions->setConfig(config);
+}
+
+void HTTPServer::setSocketOptions(const SocketOptions &options) {
+    m_socketOptions = options;
+}
+
+SessionStats HTTPServer::getSessionStats() const {
+    return m_sessions->getStats();
+}
+
+void HTTPServer::setOnSessionOpen(Session::Handler handler) {
+    m_onSessionOpen = std::move(handler);
+}
+
+void HTTPServer::setOnSessionClose(Session::Handler handler) {
+    m_onSessionClose = std::move(handler);
+}
+
 bool HTTPServer::setErrorHandler(httpd_err_code_t error, ErrorHandler handler) {
     // calls the corresponding ErrorHandler based on context
     auto nativeHandler = [](httpd_req_t *nativeRequest, httpd_err_code_t error) -> esp_err_t {
         auto server = static_cast<HTTPServer*>(httpd_get_global_user_ctx(nativeRequest->handle));
 
+        detail::RequestContext context;
+        nativeRequest->user_ctx = &context;
+
+#if CONFIG_HTTP_SERVER_METRICS
+        server->m_metrics->errorHandlerCalls.fetch_add(1, std::memory_order_relaxed);
+#endif
+
         Request request(nativeRequest);
         auto result = server->findErrorHandler(error)->second(request, error);
 
@@ -0,0 +1,112 @@
+#include <expressif/http/server/JsonWriter.h>
+
+namespace expressif::http::server {
+JsonWriter::JsonWriter(Response response)
+    : m_writer(response)
+{
+    response.setType(HTTPD_TYPE_JSON);
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    push('{');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    pop('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    push('[');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    pop(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+
+    m_writer.write('"').write(name, ChunkWriter::Escape::Json).write("\":");
+    m_isAfterKey = true;
+
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view str) {
+    separate();
+    m_writer.write('"').write(str, ChunkWriter::Escape::Json).write('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char *str) {
+    return str != nullptr ? value(std::string_view {str}) : value(nullptr);
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    return rawValue(b ? "true" : "false");
+}
+
+JsonWriter& JsonWriter::value(std::nullptr_t) {
+    return rawValue("null");
+}
+
+JsonWriter& JsonWriter::rawValue(std::string_view json) {
+    separate();
+    m_writer.write(json);
+    return *this;
+}
+
+esp_err_t JsonWriter::finish() {
+    if (m_isOverflowed)
+        return ESP_ERR_INVALID_STATE;
+
+    return m_writer.finish();
+}
+
+esp_err_t JsonWriter::getStatus() const {
+    return m_isOverflowed ? ESP_ERR_INVALID_STATE : m_writer.getStatus();
+}
+
+void JsonWriter::separate() {
+    // the value of the key
+    if (m_isAfterKey) {
+        m_isAfterKey = false;
+        return;
+    }
+
+    if (m_depth == 0)
+        return;
+
+    if (m_hasElements[m_depth - 1]) {
+        m_writer.write(',');
+    } else {
+        m_hasElements[m_depth - 1] = true;
+    }
+}
+
+void JsonWriter::push(char bracket) {
+    separate();
+
+    if (m_depth == MaxDepth) {
+        m_isOverflowed = true;
+        return;
+    }
+
+    m_hasElements[m_depth++] = false;
+    m_writer.write(bracket);
+}
+
+void JsonWriter::pop(char bracket) {
+    if (m_depth == 0) {
+        m_isOverflowed = true;
+        return;
+    }
+
+    --m_depth;
+    m_writer.write(bracket);
+}
+}
@@ -0,0 +1,18 @@
+#include <expressif/http/server/Middleware.h>
+
+namespace expressif::http::server {
+Next::Next(Request &request, std::span<const Middleware> chain, Endpoint endpoint, void *arg)
+    : m_request(request),
+      m_chain(chain),
+      m_endpoint(endpoint),
+      m_arg(arg) {}
+
+HandlerResult Next::operator()() const {
+    if (m_chain.empty())
+        return m_endpoint(m_arg);
+
+    Next next(m_request, m_chain.subspan(1), m_endpoint, m_arg);
+
+    return m_chain.front()(m_request, next);
+}
+}
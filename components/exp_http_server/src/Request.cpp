@@ -1,18 +1,37 @@
 #include <expressif/http/server/Request.h>
 #include <expressif/http/server/util/URIPathParser.h>
 #include <expressif/http/server/util/URIUtils.h>
+#include <expressif/http/server/util/ETag.h>
+#include <expressif/http/server/util/HTTPDate.h>
 
 #include "detail/EndpointData.h"
+#include "detail/RequestContext.h"
+#include "detail/Tracer.h"
 #include "sdkconfig.h"
 
+#include <algorithm>
+
 namespace expressif::http::server {
 Request::Request(httpd_req_t *req)
     : m_req(req) {}
 
+std::pmr::memory_resource* Request::getArena() const {
+    auto context = detail::RequestContext::of(m_req);
+    return context != nullptr ? context->getArena() : std::pmr::get_default_resource();
+}
+
 std::string Request::getHeader(std::string_view name) const {
     auto size = httpd_req_get_hdr_value_len(m_req, name.data());
     std::string result(size, '\0');
-    httpd_req_get_hdr_value_str(m_req, name.data(), result.data(), size);
+    // size + 1: the value is null-terminated
+    httpd_req_get_hdr_value_str(m_req, name.data(), result.data(), size + 1);
+    return result;
+}
+
+std::pmr::string Request::getHeader(std::string_view name, std::pmr::memory_resource *resource) const {
+    auto size = httpd_req_get_hdr_value_len(m_req, name.data());
+    std::pmr::string result(size, '\0', resource);
+    httpd_req_get_hdr_value_str(m_req, name.data(), result.data(), size + 1);
     return result;
 }
 
@@ -21,13 +40,18 @@ bool Request::hasHeader(std::string_view name) const {
 }
 
 const std::string& Request::getPathVar(std::string_view name) {
-    return getPathVars().at(name.data());
+    return getPathVars().at(std::string(name));
 }
 
 const PathVars& Request::getPathVars() {
     if (!m_pathVars.has_value()) {
-        auto context = static_cast<detail::EndpointData*>(m_req->user_ctx);
-        m_pathVars = URIPathParser::parse(context->uriTemplate, m_req->uri);
+        auto context = detail::RequestContext::of(m_req);
+
+        if (context != nullptr && context->endpoint != nullptr) {
+            m_pathVars = URIPathParser::parse(context->endpoint->uriTemplate, m_req->uri);
+        } else {
+            m_pathVars = PathVars {};
+        }
     }
 
     return m_pathVars.value();
@@ -38,35 +62,76 @@ bool Request::hasPathVar(std::string_view name) {
     return vars.contains({name.begin(), name.end()});
 }
 
-std::string Request::getQueryStr() const {
+std::pmr::string Request::getQueryStr() const {
     auto size = httpd_req_get_url_query_len(m_req) + 1;
-    std::string result(size, '\0');
+    std::pmr::string result(size, '\0', getArena());
     httpd_req_get_url_query_str(m_req, result.data(), size);
     return result;
 }
 
-std::string Request::getQueryParam(std::string_view queryStr, std::string_view name) {
+std::pmr::string Request::getQueryParam(
+    std::string_view queryStr, std::string_view name, std::pmr::memory_resource *resource
+) const {
     char value[CONFIG_HTTP_SERVER_QUERY_VALUE_MAX_LEN] = {0};
-    char decValue[CONFIG_HTTP_SERVER_QUERY_VALUE_MAX_LEN] = {0};
 
     if (httpd_query_key_value(queryStr.data(), name.data(), value, sizeof(value)) != ESP_OK)
-        return {};
-
-    URIUtils::decode(decValue, {value, strnlen(value, CONFIG_HTTP_SERVER_QUERY_VALUE_MAX_LEN)});
+        return std::pmr::string {resource};
 
-    return decValue;
+    return URIUtils::decode({value, strnlen(value, CONFIG_HTTP_SERVER_QUERY_VALUE_MAX_LEN)}, resource);
 }
 
 std::string Request::getQueryParam(std::string_view name) const {
-    return getQueryParam(getQueryStr(), name);
+    return std::string(getQueryParam(getQueryStr(), name, getArena()));
+}
+
+std::pmr::string Request::getQueryParam(std::string_view name, std::pmr::memory_resource *resource) const {
+    return getQueryParam(getQueryStr(), name, resource);
 }
 
 size_t Request::getContentLength() const {
     return m_req->content_len;
 }
 
+Session* Request::getSession() const {
+    return Session::of(m_req);
+}
+
+bool Request::isNotModified(const Validators &validators) const {
+    // If-None-Match takes precedence over If-Modified-Since, see RFC 9110, 13.1.3
+    if (hasHeader("If-None-Match"))
+        return ETag::matches(getHeader("If-None-Match", getArena()), validators.etag);
+
+    if (validators.lastModified == 0 || (m_req->method != HTTP_GET && m_req->method != HTTP_HEAD))
+        return false;
+
+    if (auto since = HTTPDate::parse(getHeader("If-Modified-Since", getArena())); since.has_value())
+        return validators.lastModified <= *since;
+
+    return false;
+}
+
+bool Request::checkNotModified(const Validators &validators) {
+    if (isNotModified(validators)) {
+        response().notModified(validators);
+        return true;
+    }
+
+    response().setValidators(validators);
+
+    return false;
+}
+
 int Request::readChunk(Buffer buff) const {
-    return httpd_req_recv(m_req, reinterpret_cast<char*>(buff.data()), buff.size());
+    detail::TraceSpan span(m_req, detail::TracePhase::Receive);
+
+    auto ret = httpd_req_recv(m_req, reinterpret_cast<char*>(buff.data()), buff.size());
+    span.setValue(std::max(ret, 0));
+
+    return ret;
+}
+
+ReadChunkAwaiter Request::readChunkAsync(Buffer buff) const {
+    return {m_req, buff};
 }
 
 bool Request::isValid() const {
@@ -76,4 +141,30 @@ bool Request::isValid() const {
 Response Request::response() {
     return Response {m_req};
 }
+
+AsyncRequest Request::detach() {
+    auto context = detail::RequestContext::of(m_req);
+
+    if (context == nullptr)
+        return {};
+
+    httpd_req_t *copy = nullptr;
+
+    if (httpd_req_async_handler_begin(m_req, &copy) != ESP_OK)
+        return {};
+
+    // the endpoint may be removed meanwhile
+    getPathVars();
+
+    // the original context lives on the stack of the server task
+    auto ownedContext = std::make_unique<detail::RequestContext>(std::move(*context));
+    copy->user_ctx = ownedContext.get();
+
+    auto request = std::make_unique<Request>(copy);
+    request->m_pathVars = std::move(m_pathVars);
+
+    m_req = nullptr;
+
+    return {copy, std::move(ownedContext), std::move(request)};
+}
 }
@@ -1,8 +1,26 @@
 #include <expressif/http/server/Response.h>
+#include <expressif/http/server/SocketAwaiter.h>
+#include <expressif/http/server/util/HTTPDate.h>
+#include <expressif/http/server/util/AcceptEncoding.h>
+#include <expressif/http/server/util/ETag.h>
 #include <expressif/expressif_info.h>
 
+#include "detail/RequestContext.h"
+#include "detail/ResponseWriter.h"
+#include "detail/Tracer.h"
+
 #include <sdkconfig.h>
 
+#include <esp_random.h>
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include <spi_flash_mmap.h>
+#endif
+
+#include <algorithm>
+#include <charconv>
+#include <cinttypes>
+
 #define HTTP_SERVER_VERSION_INFO \
 EXPRESSIF_DISPLAY_NAME " " EXPRESSIF_VERSION_STR " HTTP Server running on " CONFIG_IDF_TARGET
 
@@ -29,30 +47,230 @@ constexpr static auto default500Message = R"(
 <br><br>
 )" HTTP_SERVER_VERSION_INFO_FORMATTED;
 
+#if CONFIG_IDF_TARGET_LINUX
+// the flash emulation is not paged
+constexpr static size_t MmuPageSize = 1;
+#else
+constexpr static size_t MmuPageSize = SPI_FLASH_MMU_PAGE_SIZE;
+#endif
+
+// a whole number of MMU pages, see Response::writeChunks(const esp_partition_t*, ...)
+constexpr static size_t PartitionWindowSize =
+    (CONFIG_HTTP_SERVER_PARTITION_WINDOW_SIZE + MmuPageSize - 1) / MmuPageSize * MmuPageSize;
+
+// the bodies sent along with the head by writeAll
+constexpr static size_t SmallBodySize = 512;
+
 Response::Response(httpd_req_t *&req)
     : m_req(req) {}
 
+// allocated from the arena of the request, see Request::getArena
+static std::pmr::string getRequestHeader(httpd_req_t *req, const char *name) {
+    auto context = detail::RequestContext::of(req);
+    auto size = httpd_req_get_hdr_value_len(req, name);
+    std::pmr::string result(size, '\0', context != nullptr ? context->getArena() : std::pmr::get_default_resource());
+    httpd_req_get_hdr_value_str(req, name, result.data(), size + 1);
+    return result;
+}
+
+// records the body of the response to be cached, see ResponseCache
+static void capture(httpd_req_t *req, ConstBuffer data) {
+    if (auto context = detail::RequestContext::of(req); context != nullptr && context->capture) {
+        context->capture->append(data);
+    }
+}
+
+static void completeCapture(httpd_req_t *req) {
+    if (auto context = detail::RequestContext::of(req); context != nullptr && context->capture) {
+        context->capture->isComplete = true;
+    }
+}
+
+// counts the body of the response, see detail::EndpointMetrics
+static void countBytesOut(httpd_req_t *req, ConstBuffer data) {
+#if CONFIG_HTTP_SERVER_METRICS
+    if (auto context = detail::RequestContext::of(req); context != nullptr) {
+        context->bytesOut += data.size();
+    }
+#endif
+}
+
+// the head is composed from the context, see detail::formatHead
+static detail::RequestContext* getHeadContext(httpd_req_t *req) {
+    auto context = detail::RequestContext::of(req);
+    return context != nullptr && !context->isHeadSent ? context : nullptr;
+}
+
 esp_err_t Response::setHeader(std::string_view header, std::string_view value) {
-    return httpd_resp_set_hdr(m_req, header.data(), value.data());
+    auto context = getHeadContext(m_req);
+
+    if (context == nullptr)
+        return ESP_ERR_INVALID_STATE;
+
+    context->headers.emplace_back(header.data(), value.data());
+
+    return ESP_OK;
 }
 
 esp_err_t Response::setType(std::string_view type) {
-    return httpd_resp_set_type(m_req, type.data());
+    auto context = getHeadContext(m_req);
+
+    if (context == nullptr)
+        return ESP_ERR_INVALID_STATE;
+
+    context->type = type.data();
+
+    return ESP_OK;
 }
 
 esp_err_t Response::setStatus(std::string_view status) {
-    return httpd_resp_set_status(m_req, status.data());
+    auto context = getHeadContext(m_req);
+
+    if (context == nullptr)
+        return ESP_ERR_INVALID_STATE;
+
+    context->status = status.data();
+
+    return ESP_OK;
+}
+
+esp_err_t Response::setValidators(const Validators &validators) {
+    auto context = detail::RequestContext::of(m_req);
+
+    if (context == nullptr)
+        return ESP_ERR_INVALID_STATE;
+
+    if (!validators.etag.empty()) {
+        if (auto ret = setHeader("ETag", context->store(validators.etag)); ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    if (validators.lastModified != 0) {
+        auto date = context->store(HTTPDate::format(validators.lastModified));
+
+        if (auto ret = setHeader("Last-Modified", date); ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t Response::enableCompression(size_t minSize) {
+#if CONFIG_HTTP_SERVER_COMPRESSION
+    using detail::CompressionFilter;
+
+    auto context = detail::RequestContext::of(m_req);
+
+    if (context == nullptr)
+        return ESP_ERR_INVALID_STATE;
+
+    auto acceptEncoding = getRequestHeader(m_req, "Accept-Encoding");
+
+    CompressionFilter::Format format;
+
+    if (AcceptEncoding::isAccepted(acceptEncoding, "gzip")) {
+        format = CompressionFilter::Format::Gzip;
+    } else if (AcceptEncoding::isAccepted(acceptEncoding, "deflate")) {
+        format = CompressionFilter::Format::Deflate;
+    } else {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (auto ret = setHeader("Vary", "Accept-Encoding"); ret != ESP_OK)
+        return ret;
+
+    context->compression = std::make_unique<CompressionFilter>(format, minSize);
+
+    // cached responses are compressed again for each client
+    if (context->capture)
+        context->capture->compressionMinSize = minSize;
+
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t Response::enableCompression() {
+#if CONFIG_HTTP_SERVER_COMPRESSION
+    return enableCompression(CONFIG_HTTP_SERVER_COMPRESSION_MIN_SIZE);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t Response::setContentLength(size_t length) {
+    auto context = detail::RequestContext::of(m_req);
+
+    if (context == nullptr || context->isHeadSent)
+        return ESP_ERR_INVALID_STATE;
+
+#if CONFIG_HTTP_SERVER_COMPRESSION
+    if (context->compression)
+        return ESP_ERR_INVALID_STATE;
+#endif
+
+    context->isFixedLength = true;
+    context->remainingLength = length;
+
+    return ESP_OK;
 }
 
 esp_err_t Response::writeAll(ConstBuffer data) {
-    auto status = httpd_resp_send(
-        m_req,
-        reinterpret_cast<const char *>(data.data()),
-        static_cast<ssize_t>(data.size())
-    );
+    detail::TraceSpan span(m_req, detail::TracePhase::Send);
+    span.setValue(data.size());
+
+    if (auto context = detail::RequestContext::of(m_req); context != nullptr && context->isFixedLength) {
+        if (auto ret = writeChunk(data); ret != ESP_OK) {
+            return ret;
+        }
+
+        return flush();
+    }
+
+#if CONFIG_HTTP_SERVER_COMPRESSION
+    if (auto context = detail::RequestContext::of(m_req); context != nullptr && context->compression) {
+        if (data.size() >= context->compression->getMinSize()) {
+            if (auto ret = writeChunk(data); ret != ESP_OK) {
+                return ret;
+            }
+
+            return flush();
+        }
+
+        context->compression.reset();
+    }
+#endif
+
+    auto context = getHeadContext(m_req);
+
+    if (context == nullptr)
+        return ESP_ERR_INVALID_STATE;
+
+    capture(m_req, data);
+    countBytesOut(m_req, data);
+
+    context->isHeadSent = true;
+
+    auto head = detail::formatHead(*context, detail::Framing::Length, data.size());
+
+    // small bodies are sent along with the head, in a single segment
+    if (data.size() <= SmallBodySize) {
+        head.append(reinterpret_cast<const char*>(data.data()), data.size());
+        data = {};
+    }
+
+    auto status = detail::sendAll(m_req, toBuffer(head));
 
     if (status == ESP_OK)
+        status = detail::sendAll(m_req, data);
+
+    if (status == ESP_OK) {
+        completeCapture(m_req);
         invalidate();
+    }
 
     return status;
 }
@@ -60,13 +278,40 @@ esp_err_t Response::writeAll(ConstBuffer data) {
 esp_err_t Response::writeChunk(ConstBuffer chunk) {
     if (chunk.empty()) {
         return flush();
-    } else {
-        return httpd_resp_send_chunk(
-            m_req,
-            reinterpret_cast<const char *>(chunk.data()),
-            static_cast<ssize_t>(chunk.size())
-        );
     }
+
+    detail::TraceSpan span(m_req, detail::TracePhase::Send);
+    span.setValue(chunk.size());
+
+    capture(m_req, chunk);
+    countBytesOut(m_req, chunk);
+
+    if (auto context = detail::RequestContext::of(m_req); context != nullptr && context->isFixedLength) {
+        if (chunk.size() > context->remainingLength)
+            return ESP_ERR_INVALID_SIZE;
+
+        if (!context->isHeadSent) {
+            if (auto ret = detail::sendHead(m_req, detail::Framing::Length, context->remainingLength); ret != ESP_OK) {
+                return ret;
+            }
+        }
+
+        context->remainingLength -= chunk.size();
+
+        return detail::sendAll(m_req, chunk);
+    }
+
+#if CONFIG_HTTP_SERVER_COMPRESSION
+    if (auto context = detail::RequestContext::of(m_req); context != nullptr && context->compression) {
+        return context->compression->write(m_req, chunk);
+    }
+#endif
+
+    return detail::sendChunk(m_req, chunk);
+}
+
+WriteChunkAwaiter Response::writeChunkAsync(ConstBuffer chunk) {
+    return {m_req, *this, chunk};
 }
 
 esp_err_t Response::writeChunks(ConstBuffer data, size_t chunkSize, bool flush) {
@@ -89,8 +334,95 @@ esp_err_t Response::writeChunks(ConstBuffer data, size_t chunkSize, bool flush)
     return ESP_OK;
 }
 
+esp_err_t Response::writeChunks(const esp_partition_t *partition, size_t offset, size_t size, bool flush) {
+    if (partition == nullptr || offset > partition->size || size > partition->size - offset)
+        return ESP_ERR_INVALID_ARG;
+
+    while (size > 0) {
+        // the windows are aligned to the MMU pages in flash, not to the partition,
+        // so the adjacent windows do not map the same page twice
+        auto address = partition->address + offset;
+        auto windowSize = std::min<size_t>(size, PartitionWindowSize - address % PartitionWindowSize);
+
+        const void *window;
+        esp_partition_mmap_handle_t handle;
+
+        auto ret = esp_partition_mmap(partition, offset, windowSize, ESP_PARTITION_MMAP_DATA, &window, &handle);
+
+        if (ret != ESP_OK)
+            return ret;
+
+        ret = writeChunk({static_cast<const byte_t*>(window), windowSize});
+
+        esp_partition_munmap(handle);
+
+        if (ret != ESP_OK)
+            return ret;
+
+        offset += windowSize;
+        size -= windowSize;
+    }
+
+    if (flush)
+        return this->flush();
+
+    return ESP_OK;
+}
+
+esp_err_t Response::writePartition(
+    const esp_partition_t *partition, size_t offset, size_t size,
+    const Validators &validators
+) {
+    if (partition == nullptr || offset > partition->size || size > partition->size - offset)
+        return ESP_ERR_INVALID_ARG;
+
+    return writeRanges(size, validators, [&](size_t rangeOffset, size_t length) {
+        return writeChunks(partition, offset + rangeOffset, length, false);
+    });
+}
+
+esp_err_t Response::writePartition(const esp_partition_t *partition) {
+    if (partition == nullptr)
+        return ESP_ERR_INVALID_ARG;
+
+    return writePartition(partition, 0, partition->size);
+}
+
 esp_err_t Response::flush() {
-    if (auto status = httpd_resp_send_chunk(m_req, nullptr, 0); status == ESP_OK) {
+    detail::TraceSpan span(m_req, detail::TracePhase::Send);
+
+    if (auto context = detail::RequestContext::of(m_req); context != nullptr && context->isFixedLength) {
+        if (!context->isHeadSent) {
+            if (auto ret = detail::sendHead(m_req, detail::Framing::Length, context->remainingLength); ret != ESP_OK) {
+                return ret;
+            }
+        }
+
+        // the client expects more data: the connection cannot be reused
+        if (context->remainingLength != 0) {
+            httpd_sess_trigger_close(m_req->handle, httpd_req_to_sockfd(m_req));
+            return ESP_ERR_INVALID_SIZE;
+        }
+
+        completeCapture(m_req);
+        invalidate();
+
+        return ESP_OK;
+    }
+
+#if CONFIG_HTTP_SERVER_COMPRESSION
+    if (auto context = detail::RequestContext::of(m_req); context != nullptr && context->compression) {
+        auto ret = context->compression->finish(m_req);
+        context->compression.reset();
+
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+#endif
+
+    if (auto status = detail::sendLastChunk(m_req); status == ESP_OK) {
+        completeCapture(m_req);
         invalidate();
         return status;
     } else {
@@ -98,13 +430,59 @@ esp_err_t Response::flush() {
     }
 }
 
+esp_err_t Response::notModified(const Validators &validators) {
+    auto context = detail::RequestContext::of(m_req);
+
+    if (context == nullptr || context->isHeadSent)
+        return ESP_ERR_INVALID_STATE;
+
+    if (auto ret = setStatus("304 Not Modified"); ret != ESP_OK)
+        return ret;
+
+    if (auto ret = setValidators(validators); ret != ESP_OK)
+        return ret;
+
+    // 304 has no content, see RFC 9110, 15.4.5: esp_http_server would add Content-Length
+    context->type = nullptr;
+
+    if (auto ret = detail::sendHead(m_req, detail::Framing::None); ret != ESP_OK)
+        return ret;
+
+    invalidate();
+
+    return ESP_OK;
+}
+
+/**
+ * @return The status line of the error, as sent by httpd_resp_send_err
+ * @note Mapped explicitly: httpd_err_code_t is not ordered by the status code
+ */
+static const char* getStatusLine(httpd_err_code_t code) {
+    switch (code) {
+        case HTTPD_400_BAD_REQUEST: return "400 Bad Request";
+        case HTTPD_401_UNAUTHORIZED: return "401 Unauthorized";
+        case HTTPD_403_FORBIDDEN: return "403 Forbidden";
+        case HTTPD_404_NOT_FOUND: return "404 Not Found";
+        case HTTPD_405_METHOD_NOT_ALLOWED: return "405 Method Not Allowed";
+        case HTTPD_408_REQ_TIMEOUT: return "408 Request Timeout";
+        case HTTPD_411_LENGTH_REQUIRED: return "411 Length Required";
+        case HTTPD_414_URI_TOO_LONG: return "414 URI Too Long";
+        case HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE: return "431 Request Header Fields Too Large";
+        case HTTPD_501_METHOD_NOT_IMPLEMENTED: return "501 Method Not Implemented";
+        case HTTPD_505_VERSION_NOT_SUPPORTED: return "505 Version Not Supported";
+        case HTTPD_500_INTERNAL_SERVER_ERROR:
+        default: return "500 Internal Server Error";
+    }
+}
+
 esp_err_t Response::error(httpd_err_code_t code, std::string_view message) {
-    auto status = httpd_resp_send_err(m_req, code, message.data());
+    // the same response as of httpd_resp_send_err
+    if (auto ret = setStatus(getStatusLine(code)); ret != ESP_OK)
+        return ret;
 
-    if (status == ESP_OK)
-        invalidate();
+    setType(HTTPD_TYPE_TEXT);
 
-    return status;
+    return writeAll(toBuffer(message));
 }
 
 esp_err_t Response::error404() {
@@ -119,6 +497,108 @@ esp_err_t Response::error500() {
     return error(HTTPD_500_INTERNAL_SERVER_ERROR, default500Message);
 }
 
+/**
+ * Checks whether the `If-Range` condition holds, see RFC 9110, 13.1.5
+ * @param ifRange The `If-Range` header value, may be empty
+ * @param validators The validators of the representation
+ * @return `true` if the `Range` header must be evaluated
+ */
+static bool isIfRangeSatisfied(std::string_view ifRange, const Validators &validators) {
+    if (ifRange.empty())
+        return true;
+
+    // entity tag, the strong comparison is required
+    if (ifRange.front() == '"')
+        return !validators.etag.empty() && !validators.etag.starts_with("W/") && ifRange == validators.etag;
+
+    if (ifRange.starts_with("W/"))
+        return false;
+
+    auto date = HTTPDate::parse(ifRange);
+
+    return date.has_value() && validators.lastModified != 0 && validators.lastModified == *date;
+}
+
+esp_err_t Response::prepareRanges(
+    size_t size, const Validators &validators,
+    std::vector<RangePart> &parts, std::string &tail
+) {
+    auto context = detail::RequestContext::of(m_req);
+
+    if (context == nullptr)
+        return ESP_ERR_INVALID_STATE;
+
+    if (auto ret = setHeader("Accept-Ranges", "bytes"); ret != ESP_OK)
+        return ret;
+
+    std::optional<std::vector<ByteRange>> ranges;
+
+    if (m_req->method == HTTP_GET && isIfRangeSatisfied(getRequestHeader(m_req, "If-Range"), validators)) {
+        if (auto range = getRequestHeader(m_req, "Range"); !range.empty()) {
+            ranges = ByteRange::parse(range, size);
+        }
+    }
+
+    // no applicable Range: the whole representation
+    if (!ranges.has_value()) {
+        parts.push_back({{0, size}, {}});
+        return setContentLength(size);
+    }
+
+    if (ranges->empty()) {
+        setStatus("416 Range Not Satisfiable");
+        setHeader("Content-Range", context->store("bytes */" + std::to_string(size)));
+        return writeAll(ConstBuffer {});
+    }
+
+    if (auto ret = setStatus("206 Partial Content"); ret != ESP_OK)
+        return ret;
+
+    auto contentRange = [size](const ByteRange &range) {
+        return "bytes " + std::to_string(range.offset) + "-" +
+               std::to_string(range.offset + range.length - 1) + "/" + std::to_string(size);
+    };
+
+    if (ranges->size() == 1) {
+        auto &range = ranges->front();
+
+        if (auto ret = setHeader("Content-Range", context->store(contentRange(range))); ret != ESP_OK)
+            return ret;
+
+        parts.push_back({range, {}});
+
+        return setContentLength(range.length);
+    }
+
+    // multipart/byteranges, see RFC 9110, 14.6
+    char boundary[17];
+    snprintf(boundary, sizeof(boundary), "%08" PRIx32 "%08" PRIx32, esp_random(), esp_random());
+
+    std::string_view type = context->type;
+    size_t length = 0;
+
+    for (auto &range : *ranges) {
+        std::string head;
+        head.append("\r\n--").append(boundary)
+            .append("\r\nContent-Type: ").append(type)
+            .append("\r\nContent-Range: ").append(contentRange(range))
+            .append("\r\n\r\n");
+
+        length += head.size() + range.length;
+        parts.push_back({range, std::move(head)});
+    }
+
+    tail.append("\r\n--").append(boundary).append("--\r\n");
+    length += tail.size();
+
+    auto multipartType = context->store(std::string("multipart/byteranges; boundary=") + boundary);
+
+    if (auto ret = setType(multipartType); ret != ESP_OK)
+        return ret;
+
+    return setContentLength(length);
+}
+
 void Response::invalidate() {
     m_req = nullptr;
 }
@@ -0,0 +1,68 @@
+#include <expressif/http/server/Session.h>
+
+#include <esp_timer.h>
+
+#include <utility>
+
+namespace expressif::http::server {
+constexpr static auto relaxed = std::memory_order_relaxed;
+
+static uint32_t getTimeMs() {
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+Session::Session(httpd_handle_t handle, int sockfd, std::chrono::milliseconds idleTimeout)
+    : m_handle(handle),
+      m_socket(sockfd),
+      m_lastActive(getTimeMs()),
+      m_idleTimeout(idleTimeout.count()) {}
+
+Session::~Session() {
+    resetContext();
+}
+
+int Session::getSocket() const {
+    return m_socket;
+}
+
+uint32_t Session::getRequestCount() const {
+    return m_requestCount;
+}
+
+void Session::setIdleTimeout(std::chrono::milliseconds timeout) {
+    m_idleTimeout.store(timeout.count(), relaxed);
+}
+
+void Session::resetContext() {
+    if (m_deleteContext != nullptr)
+        m_deleteContext(m_context);
+
+    m_context = nullptr;
+    m_contextType = nullptr;
+    m_deleteContext = nullptr;
+}
+
+Session* Session::of(httpd_req_t *req) {
+    return req != nullptr ? static_cast<Session*>(req->sess_ctx) : nullptr;
+}
+
+void Session::setContext(void *context, const void *type, Deleter deleter) {
+    resetContext();
+
+    m_context = context;
+    m_contextType = type;
+    m_deleteContext = deleter;
+}
+
+bool Session::isIdle(uint32_t now) const {
+    // the end of the request is published by m_isBusy, see SessionManager::endRequest
+    if (m_isBusy.load(std::memory_order_acquire))
+        return false;
+
+    // signed: the request may have ended after `now` was taken
+    auto idle = static_cast<int32_t>(now - m_lastActive.load(relaxed));
+    auto timeout = m_idleTimeout.load(relaxed);
+
+    return timeout != 0 && idle >= static_cast<int32_t>(timeout);
+}
+}
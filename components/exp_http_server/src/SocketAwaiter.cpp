@@ -0,0 +1,88 @@
+#include <expressif/http/server/SocketAwaiter.h>
+
+#include "detail/CoroutineScheduler.h"
+#include "detail/RequestContext.h"
+
+#include <sys/select.h>
+#include <sys/time.h>
+
+namespace expressif::http::server {
+namespace detail {
+SocketAwaiter::SocketAwaiter(httpd_req_t *req, SocketEvent event)
+    : m_req(req),
+      m_event(event) {}
+
+Coroutine* SocketAwaiter::getCoroutine() const {
+    auto context = RequestContext::of(m_req);
+    return context != nullptr ? context->coroutine : nullptr;
+}
+
+bool SocketAwaiter::isSocketReady() const {
+    auto fd = httpd_req_to_sockfd(m_req);
+
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+
+    timeval timeout {};
+
+    // in case of error, the operation itself reports it
+    return select(fd + 1,
+                  m_event == SocketEvent::Read ? &fds : nullptr,
+                  m_event == SocketEvent::Write ? &fds : nullptr,
+                  nullptr, &timeout) != 0;
+}
+
+void SocketAwaiter::suspend(std::coroutine_handle<> handle) {
+    m_isSuspended = true;
+    getCoroutine()->await(m_event, handle);
+}
+
+bool SocketAwaiter::isTimedOut() const {
+    return m_isSuspended && getCoroutine()->isTimedOut;
+}
+}
+
+ReadChunkAwaiter::ReadChunkAwaiter(httpd_req_t *req, Buffer buff)
+    : SocketAwaiter(req, detail::SocketEvent::Read),
+      m_buff(buff) {}
+
+bool ReadChunkAwaiter::await_ready() {
+    auto coroutine = getCoroutine();
+
+    // the socket is non-blocking while the coroutine runs: pending data
+    // is returned at once, otherwise HTTPD_SOCK_ERR_TIMEOUT
+    m_result = httpd_req_recv(m_req, reinterpret_cast<char*>(m_buff.data()), m_buff.size());
+
+    return m_result != HTTPD_SOCK_ERR_TIMEOUT || coroutine == nullptr || !coroutine->isNonBlocking;
+}
+
+void ReadChunkAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    suspend(handle);
+}
+
+int ReadChunkAwaiter::await_resume() {
+    if (m_isSuspended && !isTimedOut())
+        m_result = httpd_req_recv(m_req, reinterpret_cast<char*>(m_buff.data()), m_buff.size());
+    return m_result;
+}
+
+WriteChunkAwaiter::WriteChunkAwaiter(httpd_req_t *req, Response response, ConstBuffer chunk)
+    : SocketAwaiter(req, detail::SocketEvent::Write),
+      m_response(response),
+      m_chunk(chunk) {}
+
+bool WriteChunkAwaiter::await_ready() {
+    return getCoroutine() == nullptr || isSocketReady();
+}
+
+void WriteChunkAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    suspend(handle);
+}
+
+esp_err_t WriteChunkAwaiter::await_resume() {
+    if (isTimedOut())
+        return ESP_ERR_TIMEOUT;
+    return m_response.writeChunk(m_chunk);
+}
+}
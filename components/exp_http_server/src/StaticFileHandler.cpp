@@ -0,0 +1,197 @@
+#include <expressif/http/server/StaticFileHandler.h>
+#include <expressif/http/server/util/ETag.h>
+#include <expressif/http/server/util/MimeTypes.h>
+#include <expressif/http/server/util/AcceptEncoding.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <optional>
+
+#include "sdkconfig.h"
+
+namespace expressif::http::server {
+namespace {
+struct FileInfo {
+    off_t size;
+    time_t mtime;
+    Validators validators;
+};
+
+struct FileCloser {
+    void operator()(FILE *file) const {
+        fclose(file);
+    }
+};
+
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+using FileBuffer = std::array<byte_t, CONFIG_HTTP_SERVER_FILE_CHUNK_SIZE>;
+
+struct Sidecar {
+    std::string_view coding;
+    std::string_view extension;
+};
+
+// in order of preference
+constexpr static std::array<Sidecar, 2> sidecars {{
+    {"br", ".br"},
+    {"gzip", ".gz"}
+}};
+}
+
+struct StaticFileHandler::State {
+    std::string basePath;
+    std::string pathVar;
+    std::string indexFile;
+
+    std::mutex mutex;
+    std::map<std::string, FileInfo, std::less<>> files;
+
+    std::optional<FileInfo> getFileInfo(const std::string &path);
+};
+
+static std::optional<uint64_t> hashFile(const std::string &path) {
+    FilePtr file {fopen(path.c_str(), "rb")};
+
+    if (!file)
+        return {};
+
+    FileBuffer buff;
+    uint64_t hash = ETag::HashSeed;
+
+    while (auto n = fread(buff.data(), 1, buff.size(), file.get()))
+        hash = ETag::hash({buff.data(), n}, hash);
+
+    return hash;
+}
+
+std::optional<FileInfo> StaticFileHandler::State::getFileInfo(const std::string &path) {
+    struct stat st {};
+
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return {};
+
+    {
+        std::lock_guard lock(mutex);
+
+        if (auto it = files.find(path); it != files.end()) {
+            if (auto &info = it->second; info.size == st.st_size && info.mtime == st.st_mtime) {
+                return info;
+            }
+        }
+    }
+
+    // the file is new or has been changed: (re)calculate its hash
+    auto hash = hashFile(path);
+
+    if (!hash.has_value())
+        return {};
+
+    FileInfo info {st.st_size, st.st_mtime, {ETag::make(*hash), st.st_mtime}};
+
+    std::lock_guard lock(mutex);
+
+    return files.insert_or_assign(path, std::move(info)).first->second;
+}
+
+StaticFileHandler::StaticFileHandler(
+    std::string_view basePath,
+    std::string_view pathVar,
+    std::string_view indexFile
+) : m_state(std::make_shared<State>())
+{
+    m_state->basePath = basePath;
+    m_state->pathVar = pathVar;
+    m_state->indexFile = indexFile;
+}
+
+HandlerResult StaticFileHandler::operator()(Request &req) const {
+    std::string path;
+
+    if (req.hasPathVar(m_state->pathVar))
+        path = req.getPathVar(m_state->pathVar);
+
+    if (path.empty())
+        path = m_state->indexFile;
+
+    // do not let the client escape the base directory
+    if (path.find("..") != std::string::npos) {
+        req.response().error404();
+        return HandlerResult::Keep;
+    }
+
+    auto fullPath = m_state->basePath + "/" + path;
+    auto acceptEncoding = req.getHeader("Accept-Encoding", req.getArena());
+
+    std::optional<FileInfo> info;
+    std::string_view coding;
+
+    // prefer a precompressed sidecar, e.g. index.js.gz, if the client accepts it
+    for (auto &sidecar : sidecars) {
+        if (!AcceptEncoding::isAccepted(acceptEncoding, sidecar.coding))
+            continue;
+
+        if (info = m_state->getFileInfo(fullPath + sidecar.extension.data()); info.has_value()) {
+            fullPath += sidecar.extension;
+            coding = sidecar.coding;
+            break;
+        }
+    }
+
+    if (!info.has_value())
+        info = m_state->getFileInfo(fullPath);
+
+    if (!info.has_value()) {
+        req.response().error404();
+        return HandlerResult::Keep;
+    }
+
+    auto resp = req.response();
+
+    // the representation depends on Accept-Encoding, so caches must take it into account
+    resp.setHeader("Vary", "Accept-Encoding");
+
+    if (req.checkNotModified(info->validators))
+        return HandlerResult::Keep;
+
+    FilePtr file {fopen(fullPath.c_str(), "rb")};
+
+    if (!file) {
+        req.response().error404();
+        return HandlerResult::Keep;
+    }
+
+    resp.setType(MimeTypes::fromPath(path));
+
+    if (!coding.empty())
+        resp.setHeader("Content-Encoding", coding);
+
+    FileBuffer buff;
+
+    // only the requested ranges are read from the file
+    auto ret = resp.writeRanges(info->size, info->validators, [&](size_t offset, size_t length) {
+        if (fseek(file.get(), static_cast<long>(offset), SEEK_SET) != 0)
+            return ESP_FAIL;
+
+        while (length > 0) {
+            auto n = fread(buff.data(), 1, std::min(length, buff.size()), file.get());
+
+            if (n == 0)
+                return ESP_FAIL;
+
+            if (auto res = resp.writeChunk({buff.data(), n}); res != ESP_OK)
+                return res;
+
+            length -= n;
+        }
+
+        return ESP_OK;
+    });
+
+    return ret == ESP_OK ? HandlerResult::Keep : HandlerResult::Discard;
+}
+}
@@ -0,0 +1,177 @@
+#include <expressif/http/server/WebSocket.h>
+
+#include <esp_log.h>
+
+#include <array>
+
+#include "detail/EndpointData.h"
+#include "detail/RequestContext.h"
+#include "detail/SessionQueues.h"
+#include "sdkconfig.h"
+
+namespace expressif::http::server {
+WebSocket::~WebSocket() = default;
+
+#if CONFIG_HTTPD_WS_SUPPORT
+constexpr static auto TAG = "expressif::http::server::WebSocket";
+
+WebSocket::WebSocket(std::string_view uriTemplate, Handlers handlers)
+    : m_uri(std::string(UriPrefix).append(uriTemplate)),
+      m_endpoint(std::make_unique<detail::EndpointData>(HTTPMethod::Get, uriTemplate, EndpointHandler {}, EndpointOptions {})),
+      m_sessions(std::make_shared<detail::SessionQueues>(CONFIG_HTTP_SERVER_WS_QUEUE_SIZE)),
+      m_handlers(std::move(handlers)) {}
+
+bool WebSocket::send(ClientId client, ConstBuffer payload, FrameType type) {
+    return m_sessions->push(client, serialize(payload, type));
+}
+
+bool WebSocket::send(ClientId client, std::string_view text) {
+    return send(client, toBuffer(text), FrameType::Text);
+}
+
+size_t WebSocket::broadcast(ConstBuffer payload, FrameType type) {
+    // serialized once, shared by all queues
+    return m_sessions->pushAll(serialize(payload, type));
+}
+
+size_t WebSocket::broadcast(std::string_view text) {
+    return broadcast(toBuffer(text), FrameType::Text);
+}
+
+size_t WebSocket::getClientCount() const {
+    return m_sessions->size();
+}
+
+const char* WebSocket::getUri() const {
+    return m_uri.c_str();
+}
+
+std::string_view WebSocket::getUriTemplate() const {
+    return m_endpoint->uriTemplate;
+}
+
+void WebSocket::close(ClientId client) {
+    if (!m_sessions->remove(client))
+        return;
+
+    ESP_LOGD(TAG, "Client %i disconnected", client);
+
+    if (m_handlers.onClose) {
+        m_handlers.onClose(client);
+    }
+}
+
+std::shared_ptr<const std::string> WebSocket::serialize(ConstBuffer payload, FrameType type) {
+    // RFC 6455, 5.2: the server's frames are not masked
+    auto size = payload.size();
+
+    auto frame = std::make_shared<std::string>();
+    frame->reserve(size + 10);
+    frame->push_back(static_cast<char>(0x80 | static_cast<uint8_t>(type)));
+
+    if (size < 126) {
+        frame->push_back(static_cast<char>(size));
+    } else if (size <= 0xffff) {
+        frame->push_back(126);
+        frame->push_back(static_cast<char>(size >> 8));
+        frame->push_back(static_cast<char>(size));
+    } else {
+        frame->push_back(127);
+
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame->push_back(static_cast<char>(static_cast<uint64_t>(size) >> shift));
+        }
+    }
+
+    frame->append(reinterpret_cast<const char*>(payload.data()), size);
+
+    return frame;
+}
+
+esp_err_t WebSocket::handler(httpd_req_t *req) {
+    // esp_http_server keeps the user context of the handshake for the frames
+    auto self = static_cast<WebSocket*>(req->user_ctx);
+
+    if (req->method == HTTP_GET)
+        return self->onHandshake(req);
+
+    return self->onFrame(req);
+}
+
+esp_err_t WebSocket::onHandshake(httpd_req_t *req) {
+    auto id = httpd_req_to_sockfd(req);
+
+    // esp_http_server answers the handshake before calling the handler only if
+    // the request asks for the upgrade, the plain GET requests are passed as is
+    if (httpd_req_get_hdr_value_len(req, "Upgrade") == 0) {
+        httpd_resp_set_status(req, "426 Upgrade Required");
+        httpd_resp_set_hdr(req, "Upgrade", "websocket");
+        httpd_resp_set_hdr(req, "Connection", "Upgrade");
+        return httpd_resp_send(req, nullptr, 0);
+    }
+
+    // e.g. the upgrade to another protocol
+    if (httpd_ws_get_fd_info(req->handle, id) != HTTPD_WS_CLIENT_WEBSOCKET) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, nullptr);
+    }
+
+    m_sessions->add(req->handle, id);
+
+    ESP_LOGD(TAG, "Client %i connected", id);
+
+    if (m_handlers.onOpen) {
+        detail::RequestContext context(m_endpoint.get());
+        req->user_ctx = &context;
+
+        Request request(req);
+        m_handlers.onOpen(request, id);
+
+        req->user_ctx = this;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t WebSocket::onFrame(httpd_req_t *req) {
+    httpd_ws_frame_t frame {};
+
+    // the length only
+    if (auto ret = httpd_ws_recv_frame(req, &frame, 0); ret != ESP_OK)
+        return ret;
+
+    if (frame.len > CONFIG_HTTP_SERVER_WS_MAX_FRAME_SIZE) {
+        ESP_LOGW(TAG, "Frame of %zu bytes exceeds the limit, closing", frame.len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // small frames are received on the stack
+    std::array<byte_t, 128> stackBuffer;
+    std::unique_ptr<byte_t[]> heapBuffer;
+
+    auto payload = stackBuffer.data();
+
+    if (frame.len > stackBuffer.size()) {
+        heapBuffer = std::make_unique<byte_t[]>(frame.len);
+        payload = heapBuffer.get();
+    }
+
+    frame.payload = reinterpret_cast<uint8_t*>(payload);
+
+    if (frame.len > 0) {
+        if (auto ret = httpd_ws_recv_frame(req, &frame, frame.len); ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    if (m_handlers.onMessage) {
+        m_handlers.onMessage(httpd_req_to_sockfd(req), Frame {
+            .type = static_cast<FrameType>(frame.type),
+            .payload = {payload, frame.len},
+            .isFinal = frame.final
+        });
+    }
+
+    return ESP_OK;
+}
+#endif
+}
@@ -0,0 +1,169 @@
+#include "CompressionFilter.h"
+
+#if CONFIG_HTTP_SERVER_COMPRESSION
+#include "RequestContext.h"
+#include "ResponseWriter.h"
+
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+#include <miniz.h>
+
+namespace expressif::http::server::detail {
+// RFC 1952: ID1 ID2 CM FLG MTIME(4) XFL OS(unknown)
+constexpr static uint8_t gzipHeader[] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+
+CompressionFilter::CompressionFilter(Format format, size_t minSize)
+    : m_format(format),
+      m_state(State::Buffering),
+      m_minSize(minSize),
+      m_compressor(),
+      m_req(),
+      m_sendStatus(ESP_OK),
+      m_crc(0),
+      m_inputSize(0) {}
+
+CompressionFilter::~CompressionFilter() {
+    heap_caps_free(m_compressor);
+}
+
+esp_err_t CompressionFilter::write(httpd_req_t *req, ConstBuffer data) {
+    switch (m_state) {
+        case State::Buffering:
+            if (m_pending.size() + data.size() < m_minSize) {
+                m_pending.insert(m_pending.end(), data.begin(), data.end());
+                return ESP_OK;
+            }
+
+            if (auto ret = activate(req); ret != ESP_OK)
+                return ret;
+
+            return write(req, data);
+
+        case State::Compressing:
+            m_req = req;
+            return compress(data, false);
+
+        case State::PassThrough:
+        default:
+            return sendChunk(req, data);
+    }
+}
+
+esp_err_t CompressionFilter::finish(httpd_req_t *req) {
+    switch (m_state) {
+        case State::Buffering:
+            // the body is too small to be compressed
+            m_state = State::PassThrough;
+            return sendPending(req);
+
+        case State::Compressing: {
+            m_req = req;
+
+            if (auto ret = compress({}, true); ret != ESP_OK)
+                return ret;
+
+            m_state = State::PassThrough;
+
+            if (m_format == Format::Gzip) {
+                // CRC32 and ISIZE, little endian
+                uint8_t trailer[8];
+
+                for (int i = 0; i < 4; ++i) {
+                    trailer[i] = static_cast<uint8_t>(m_crc >> (i * 8));
+                    trailer[i + 4] = static_cast<uint8_t>(m_inputSize >> (i * 8));
+                }
+
+                return sendChunk(req, {reinterpret_cast<const byte_t*>(trailer), sizeof(trailer)});
+            }
+
+            return ESP_OK;
+        }
+
+        case State::PassThrough:
+        default:
+            return ESP_OK;
+    }
+}
+
+size_t CompressionFilter::getMinSize() const {
+    return m_minSize;
+}
+
+esp_err_t CompressionFilter::activate(httpd_req_t *req) {
+    m_compressor = heap_caps_malloc_prefer(
+        sizeof(tdefl_compressor), 2,
+        MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+        MALLOC_CAP_DEFAULT);
+
+    if (m_compressor == nullptr) {
+        // not enough memory: send the body as is
+        m_state = State::PassThrough;
+        return sendPending(req);
+    }
+
+    int flags = CONFIG_HTTP_SERVER_COMPRESSION_PROBES & TDEFL_MAX_PROBES_MASK;
+
+    if (m_format == Format::Deflate)
+        flags |= TDEFL_WRITE_ZLIB_HEADER;
+
+    if (tdefl_init(static_cast<tdefl_compressor*>(m_compressor), putBuf, this, flags) != TDEFL_STATUS_OKAY)
+        return ESP_FAIL;
+
+    m_state = State::Compressing;
+
+    if (auto context = RequestContext::of(req); context == nullptr || context->isHeadSent) {
+        return ESP_ERR_INVALID_STATE;
+    } else {
+        context->headers.emplace_back("Content-Encoding", m_format == Format::Gzip ? "gzip" : "deflate");
+    }
+
+    if (m_format == Format::Gzip) {
+        if (auto ret = sendChunk(req, {reinterpret_cast<const byte_t*>(gzipHeader), sizeof(gzipHeader)}); ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    m_req = req;
+
+    auto ret = compress(m_pending, false);
+
+    m_pending.clear();
+    m_pending.shrink_to_fit();
+
+    return ret;
+}
+
+esp_err_t CompressionFilter::compress(ConstBuffer data, bool finish) {
+    if (m_format == Format::Gzip && !data.empty()) {
+        m_crc = esp_rom_crc32_le(m_crc, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+        m_inputSize += data.size();
+    }
+
+    auto status = tdefl_compress_buffer(
+        static_cast<tdefl_compressor*>(m_compressor), data.data(), data.size(), finish ? TDEFL_FINISH : TDEFL_NO_FLUSH);
+
+    if (m_sendStatus != ESP_OK)
+        return m_sendStatus;
+
+    return status >= TDEFL_STATUS_OKAY ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t CompressionFilter::sendPending(httpd_req_t *req) {
+    if (m_pending.empty())
+        return ESP_OK;
+
+    auto ret = sendChunk(req, m_pending);
+
+    m_pending.clear();
+    m_pending.shrink_to_fit();
+
+    return ret;
+}
+
+int CompressionFilter::putBuf(const void *buf, int len, void *user) {
+    auto self = static_cast<CompressionFilter*>(user);
+    self->m_sendStatus = sendChunk(self->m_req, {static_cast<const byte_t*>(buf), static_cast<size_t>(len)});
+    return self->m_sendStatus == ESP_OK;
+}
+}
+#endif //CONFIG_HTTP_SERVER_COMPRESSION
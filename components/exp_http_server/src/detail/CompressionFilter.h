@@ -0,0 +1,74 @@
+#ifndef EXPRESSIF_COMPRESSIONFILTER_H
+#define EXPRESSIF_COMPRESSIONFILTER_H
+
+#include <esp_http_server.h>
+
+#include <vector>
+
+#include "../../include/expressif/http/server/Buffer.h"
+
+#include "sdkconfig.h"
+
+#if CONFIG_HTTP_SERVER_COMPRESSION
+namespace expressif::http::server::detail {
+/**
+ * Compresses the response body on the fly and sends it in chunks.
+ * The first `minSize` bytes are buffered: if the body turns out to be
+ * smaller, it is sent uncompressed and the compressor is never allocated.
+ */
+class CompressionFilter {
+public:
+    enum class Format {
+        Gzip,
+        Deflate
+    };
+
+public:
+    CompressionFilter(Format format, size_t minSize);
+    ~CompressionFilter();
+
+    CompressionFilter(const CompressionFilter&) = delete;
+    CompressionFilter& operator=(const CompressionFilter&) = delete;
+
+    esp_err_t write(httpd_req_t *req, ConstBuffer data);
+
+    /**
+     * Sends the rest of the compressed data, but not the terminating chunk.
+     */
+    esp_err_t finish(httpd_req_t *req);
+
+    size_t getMinSize() const;
+
+private:
+    esp_err_t activate(httpd_req_t *req);
+    esp_err_t compress(ConstBuffer data, bool finish);
+    esp_err_t sendPending(httpd_req_t *req);
+
+    static int putBuf(const void *buf, int len, void *user);
+
+private:
+    enum class State {
+        Buffering,
+        Compressing,
+        PassThrough
+    };
+
+private:
+    Format m_format;
+    State m_state;
+    size_t m_minSize;
+
+    std::vector<byte_t> m_pending;
+    void *m_compressor; // tdefl_compressor
+
+    // the request the compressed data is being written to
+    httpd_req_t *m_req;
+    esp_err_t m_sendStatus;
+
+    uint32_t m_crc;
+    uint32_t m_inputSize;
+};
+}
+#endif //CONFIG_HTTP_SERVER_COMPRESSION
+
+#endif //EXPRESSIF_COMPRESSIONFILTER_H
@@ -0,0 +1,307 @@
+#include "CoroutineScheduler.h"
+#include "RequestContext.h"
+
+#include "../../include/expressif/http/server/Request.h"
+
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <sdkconfig.h>
+
+#include <fcntl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+namespace expressif::http::server::detail {
+constexpr static auto TAG = "expressif::http::server::CoroutineScheduler";
+
+// only the server task spawns the coroutines, see CoroutineScheduler::spawn
+constexpr static UBaseType_t QueueSize = 4;
+
+// the same mapping as the one of esp_http_server
+static int toSocketError() {
+    switch (errno) {
+        case EAGAIN:
+        case EINTR:
+            return HTTPD_SOCK_ERR_TIMEOUT;
+        case EINVAL:
+        case EBADF:
+        case EFAULT:
+        case ENOTSOCK:
+            return HTTPD_SOCK_ERR_INVALID;
+        default:
+            return HTTPD_SOCK_ERR_FAIL;
+    }
+}
+
+// used while the coroutine runs: HTTPD_SOCK_ERR_TIMEOUT if there is no data, see ReadChunkAwaiter
+static int recvNonBlocking(httpd_handle_t, int sockfd, char *buf, size_t buf_len, int flags) {
+    auto ret = recv(sockfd, buf, buf_len, flags | MSG_DONTWAIT);
+    return ret < 0 ? toSocketError() : static_cast<int>(ret);
+}
+
+// restored when the coroutine finishes, the same as the default one of esp_http_server
+static int recvBlocking(httpd_handle_t, int sockfd, char *buf, size_t buf_len, int flags) {
+    auto ret = recv(sockfd, buf, buf_len, flags);
+    return ret < 0 ? toSocketError() : static_cast<int>(ret);
+}
+
+static bool isExpired(TickType_t deadline, TickType_t now) {
+    return static_cast<int32_t>(now - deadline) >= 0;
+}
+
+Coroutine::Coroutine(AsyncRequest request)
+    : fd(httpd_req_to_sockfd(request.m_req)),
+      m_request(std::move(request))
+{
+    auto req = m_request.m_req;
+
+    RequestContext::of(req)->coroutine = this;
+
+    // custom transports (e.g. TLS) cannot be read without blocking
+    if (httpd_sess_get_transport_ctx(req->handle, fd) == nullptr) {
+        isNonBlocking = httpd_sess_set_recv_override(req->handle, fd, recvNonBlocking) == ESP_OK;
+    }
+}
+
+Coroutine::~Coroutine() {
+    auto req = m_request.m_req;
+
+    if (req == nullptr)
+        return;
+
+    auto result = m_task.isValid() && m_task.isDone() ?
+        m_task.m_handle.promise().result() : HandlerResult::Discard;
+
+    // the frame may refer to the request
+    m_task = {};
+
+    if (isNonBlocking)
+        httpd_sess_set_recv_override(req->handle, fd, recvBlocking);
+
+    if (result != HandlerResult::Keep) {
+        // the same as returning ESP_FAIL from the handler in the server task
+        httpd_sess_trigger_close(req->handle, fd);
+    }
+}
+
+bool Coroutine::start(const CoroutineHandler &handler) {
+    m_task = handler(m_request.request());
+
+    if (!m_task.isValid()) {
+        ESP_LOGE(TAG, "Cannot allocate the coroutine frame");
+        m_request.response().error500();
+        return false;
+    }
+
+    m_task.m_handle.resume();
+
+    return true;
+}
+
+void Coroutine::await(SocketEvent event, std::coroutine_handle<> awaiter) {
+    this->event = event;
+    isTimedOut = false;
+    m_awaiter = awaiter;
+
+    // esp_http_server sets the timeouts of the sockets, see Config::recv_wait_timeout
+    timeval timeout {};
+    socklen_t size = sizeof(timeout);
+    auto option = event == SocketEvent::Read ? SO_RCVTIMEO : SO_SNDTIMEO;
+
+    if (getsockopt(fd, SOL_SOCKET, option, &timeout, &size) == 0 && (timeout.tv_sec > 0 || timeout.tv_usec > 0)) {
+        deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout.tv_sec * 1000 + timeout.tv_usec / 1000);
+    } else {
+        deadline.reset();
+    }
+}
+
+void Coroutine::resume(bool isTimedOut) {
+    this->isTimedOut = isTimedOut;
+    std::exchange(m_awaiter, {}).resume();
+}
+
+bool Coroutine::isDone() const {
+    return m_task.isDone();
+}
+
+CoroutineScheduler::CoroutineScheduler()
+    : m_queue(xQueueCreate(QueueSize, sizeof(Coroutine*))),
+      m_stopped(xSemaphoreCreateCounting(1, 0))
+{
+    if (m_queue == nullptr || m_stopped == nullptr)
+        return;
+
+    auto ret = xTaskCreate(
+        run, "http_coro", CONFIG_HTTP_SERVER_CORO_STACK_SIZE, this, CONFIG_HTTP_SERVER_CORO_PRIORITY, nullptr);
+
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Cannot create the coroutine task");
+        return;
+    }
+
+    m_isRunning = true;
+}
+
+CoroutineScheduler::~CoroutineScheduler() {
+    if (m_isRunning) {
+        Coroutine *stop = nullptr;
+        xQueueSend(m_queue, &stop, portMAX_DELAY);
+        xSemaphoreTake(m_stopped, portMAX_DELAY);
+    }
+
+    if (m_queue != nullptr)
+        vQueueDelete(m_queue);
+
+    if (m_stopped != nullptr) {
+        vSemaphoreDelete(m_stopped);
+    }
+}
+
+bool CoroutineScheduler::isValid() const {
+    return m_isRunning;
+}
+
+bool CoroutineScheduler::spawn(Request &request, const CoroutineHandler &handler) {
+    if (!isValid())
+        return false;
+
+    auto async = request.detach();
+
+    if (!async.isValid())
+        return false;
+
+    auto coroutine = std::make_unique<Coroutine>(std::move(async));
+
+    // the coroutine may finish without being suspended
+    if (!coroutine->start(handler) || coroutine->isDone())
+        return true;
+
+    auto queued = coroutine.release();
+    xQueueSend(m_queue, &queued, portMAX_DELAY);
+
+    return true;
+}
+
+void CoroutineScheduler::run(void *arg) {
+    auto self = static_cast<CoroutineScheduler*>(arg);
+
+    std::vector<std::unique_ptr<Coroutine>> coroutines;
+    Coroutine *spawned;
+
+    while (true) {
+        // blocks only if there is nothing else to wait for
+        auto timeout = coroutines.empty() ? portMAX_DELAY : 0;
+
+        if (xQueueReceive(self->m_queue, &spawned, timeout) == pdTRUE) {
+            if (spawned == nullptr)
+                break;
+
+            coroutines.emplace_back(spawned);
+
+            continue;
+        }
+
+        poll(coroutines);
+    }
+
+    // the suspended coroutines are destroyed, their sessions are closed
+    coroutines.clear();
+
+    while (xQueueReceive(self->m_queue, &spawned, 0) == pdTRUE)
+        delete spawned;
+
+    xSemaphoreGive(self->m_stopped);
+    vTaskDelete(nullptr);
+}
+
+int CoroutineScheduler::selectClosed(
+    const std::vector<std::unique_ptr<Coroutine>> &coroutines, fd_set &readFds, fd_set &writeFds
+) {
+    FD_ZERO(&readFds);
+    FD_ZERO(&writeFds);
+
+    int count = 0;
+
+    for (auto &coroutine : coroutines) {
+        if (fcntl(coroutine->fd, F_GETFL) < 0 && errno == EBADF) {
+            FD_SET(coroutine->fd, coroutine->event == SocketEvent::Read ? &readFds : &writeFds);
+            ++count;
+        }
+    }
+
+    // closed and reused meanwhile, nothing to resume
+    if (count == 0)
+        errno = EBADF;
+
+    return count != 0 ? count : -1;
+}
+
+void CoroutineScheduler::poll(std::vector<std::unique_ptr<Coroutine>> &coroutines) {
+    fd_set readFds;
+    fd_set writeFds;
+    FD_ZERO(&readFds);
+    FD_ZERO(&writeFds);
+
+    int maxFd = -1;
+
+    auto now = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(CONFIG_HTTP_SERVER_CORO_POLL_INTERVAL);
+
+    for (auto &coroutine : coroutines) {
+        FD_SET(coroutine->fd, coroutine->event == SocketEvent::Read ? &readFds : &writeFds);
+        maxFd = std::max(maxFd, coroutine->fd);
+
+        if (auto &deadline = coroutine->deadline; deadline.has_value()) {
+            timeout = isExpired(*deadline, now) ? 0 : std::min<TickType_t>(timeout, *deadline - now);
+        }
+    }
+
+    auto timeoutMs = timeout * portTICK_PERIOD_MS;
+
+    timeval selectTimeout {
+        .tv_sec = static_cast<time_t>(timeoutMs / 1000),
+        .tv_usec = static_cast<suseconds_t>(timeoutMs % 1000 * 1000)
+    };
+
+    auto ret = select(maxFd + 1, &readFds, &writeFds, nullptr, &selectTimeout);
+
+    // one of the sockets has been closed: only its coroutine is resumed,
+    // so the failing operation reports the error
+    if (ret < 0 && errno == EBADF)
+        ret = selectClosed(coroutines, readFds, writeFds);
+
+    // otherwise retrying at once would spin, the deadlines are checked next time
+    if (ret < 0) {
+        ESP_LOGW(TAG, "select failed: %i", errno);
+        vTaskDelay(1);
+        return;
+    }
+
+    now = xTaskGetTickCount();
+
+    for (auto it = coroutines.begin(); it != coroutines.end();) {
+        auto &coroutine = **it;
+
+        auto &fds = coroutine.event == SocketEvent::Read ? readFds : writeFds;
+        bool isReady = ret > 0 && FD_ISSET(coroutine.fd, &fds);
+        bool isTimedOut = !isReady && coroutine.deadline.has_value() && isExpired(*coroutine.deadline, now);
+
+        if (isReady || isTimedOut) {
+            coroutine.resume(isTimedOut);
+
+            if (coroutine.isDone()) {
+                // completes the request
+                it = coroutines.erase(it);
+                continue;
+            }
+        }
+
+        ++it;
+    }
+}
+}
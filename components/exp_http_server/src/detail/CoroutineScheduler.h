@@ -0,0 +1,115 @@
+#ifndef EXPRESSIF_COROUTINESCHEDULER_H
+#define EXPRESSIF_COROUTINESCHEDULER_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include <sys/select.h>
+
+#include <coroutine>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "../../include/expressif/http/server/AsyncRequest.h"
+#include "../../include/expressif/http/server/EndpointHandler.h"
+#include "../../include/expressif/http/server/SocketAwaiter.h"
+#include "../../include/expressif/http/server/Task.h"
+
+namespace expressif::http::server::detail {
+/**
+ * The coroutine endpoint handling the detached request.
+ */
+class Coroutine {
+public:
+    explicit Coroutine(AsyncRequest request);
+
+    /**
+     * Closes the session if the coroutine has not finished successfully
+     * and completes the request.
+     */
+    ~Coroutine();
+
+    Coroutine(const Coroutine&) = delete;
+    Coroutine& operator=(const Coroutine&) = delete;
+
+    /**
+     * Runs the coroutine until it is suspended for the first time.
+     * @return `false` if the frame cannot be allocated
+     */
+    bool start(const CoroutineHandler &handler);
+
+    /**
+     * Suspends the coroutine until the socket is ready, called by the awaiters.
+     * @param event The event to wait for
+     * @param awaiter The suspended coroutine, may be nested in the coroutine of the endpoint
+     */
+    void await(SocketEvent event, std::coroutine_handle<> awaiter);
+
+    void resume(bool isTimedOut);
+
+    bool isDone() const;
+
+public:
+    int fd;
+
+    // false in case of custom transports (e.g. TLS): reads block in that case
+    bool isNonBlocking {false};
+
+    SocketEvent event {SocketEvent::Read};
+    std::optional<TickType_t> deadline;
+    bool isTimedOut {false};
+
+private:
+    // declared first: the frame may refer to the request
+    AsyncRequest m_request;
+    Task<HandlerResult> m_task;
+    std::coroutine_handle<> m_awaiter;
+};
+
+/**
+ * Resumes the suspended coroutine endpoints in a dedicated FreeRTOS task
+ * when their sockets become ready, so many slow connections are served
+ * without blocking the server task.
+ */
+class CoroutineScheduler {
+public:
+    CoroutineScheduler();
+
+    /**
+     * Stops the task, the suspended coroutines are destroyed
+     * and their sessions are closed.
+     */
+    ~CoroutineScheduler();
+
+    CoroutineScheduler(const CoroutineScheduler&) = delete;
+    CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+    bool isValid() const;
+
+    /**
+     * Detaches the request and runs the coroutine until it is suspended
+     * for the first time, after that it is resumed by the scheduler.
+     * @return `false` if the coroutine cannot be started
+     */
+    bool spawn(Request &request, const CoroutineHandler &handler);
+
+private:
+    static void run(void *arg);
+
+    // waits for the sockets and resumes the ready coroutines
+    static void poll(std::vector<std::unique_ptr<Coroutine>> &coroutines);
+
+    // leaves only the closed sockets in the sets, after select has failed with EBADF
+    static int selectClosed(
+            const std::vector<std::unique_ptr<Coroutine>> &coroutines, fd_set &readFds, fd_set &writeFds);
+
+private:
+    QueueHandle_t m_queue;
+    SemaphoreHandle_t m_stopped;
+    bool m_isRunning {false};
+};
+}
+
+#endif //EXPRESSIF_COROUTINESCHEDULER_H
@@ -1,8 +1,14 @@
 #ifndef EXPRESSIF_ENDPOINTDATA_H
 #define EXPRESSIF_ENDPOINTDATA_H
 
+#include <memory>
 #include <string>
+
+#include "Metrics.h"
+#include "RateLimiter.h"
+
 #include "../../include/expressif/http/server/EndpointHandler.h"
+#include "../../include/expressif/http/server/EndpointOptions.h"
 #include "../../include/expressif/http/server/HTTPMethod.h"
 #include "../../include/expressif/http/server/util/URIPathParser.h"
 
@@ -10,19 +16,41 @@ namespace expressif::http::server {
 class HTTPServer;
 
 namespace detail {
-class EndpointData {
+// shared with the offloaded requests, which may outlive the endpoint
+class EndpointData : public std::enable_shared_from_this<EndpointData> {
 public:
-    inline EndpointData(HTTPMethod method, std::string_view tmp, EndpointHandler handler)
+    inline EndpointData(HTTPMethod method, std::string_view tmp, EndpointHandler handler, EndpointOptions options)
         : method(method),
           uriTemplate(tmp),
           handler(std::move(handler)),
+          options(std::move(options)),
+          priority(URIPathParser::calcPriority(tmp)) {}
+
+    inline EndpointData(HTTPMethod method, std::string_view tmp, CoroutineHandler handler, EndpointOptions options)
+        : method(method),
+          uriTemplate(tmp),
+          coroutineHandler(std::move(handler)),
+          options(std::move(options)),
           priority(URIPathParser::calcPriority(tmp)) {}
 
 public:
     HTTPMethod method;
     std::string uriTemplate;
+
+    // one of them is set
     EndpointHandler handler;
+    CoroutineHandler coroutineHandler;
+
+    EndpointOptions options;
     ssize_t priority;
+
+    // set if EndpointOptions::rateLimit is set
+    std::unique_ptr<RateLimiter> rateLimiter;
+
+#if CONFIG_HTTP_SERVER_METRICS
+    // shared with the requests in flight, which may outlive the endpoint
+    std::shared_ptr<EndpointMetrics> metrics;
+#endif
 };
 }
 }
@@ -0,0 +1,78 @@
+#include "../../include/expressif/http/server/Task.h"
+
+#include <esp_log.h>
+#include <sdkconfig.h>
+
+#include <cstdlib>
+#include <mutex>
+
+namespace expressif::http::server::detail {
+constexpr static auto TAG = "expressif::http::server::FramePool";
+
+constexpr static size_t BlockAlignment = alignof(std::max_align_t);
+constexpr static size_t BlockSize = (CONFIG_HTTP_SERVER_CORO_FRAME_SIZE + BlockAlignment - 1) / BlockAlignment * BlockAlignment;
+constexpr static size_t BlockCount = CONFIG_HTTP_SERVER_CORO_FRAME_COUNT;
+
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+// the frames are allocated and freed by the server task and the coroutine task
+static std::mutex mutex;
+static std::byte *pool = nullptr;
+static FreeBlock *freeBlocks = nullptr;
+
+// must be called with the locked mutex
+static void initPool() {
+    pool = static_cast<std::byte*>(std::malloc(BlockSize * BlockCount));
+
+    if (pool == nullptr) {
+        ESP_LOGW(TAG, "Cannot allocate the pool, the frames are allocated on the heap");
+        return;
+    }
+
+    for (size_t i = BlockCount; i > 0; --i) {
+        auto block = reinterpret_cast<FreeBlock*>(pool + (i - 1) * BlockSize);
+        block->next = freeBlocks;
+        freeBlocks = block;
+    }
+}
+
+static bool isPooled(const void *frame) {
+    auto bytes = static_cast<const std::byte*>(frame);
+    return pool != nullptr && bytes >= pool && bytes < pool + BlockSize * BlockCount;
+}
+
+void* allocateFrame(size_t size) noexcept {
+    if (size <= BlockSize) {
+        std::lock_guard lock(mutex);
+
+        if (pool == nullptr)
+            initPool();
+
+        if (auto block = freeBlocks; block != nullptr) {
+            freeBlocks = block->next;
+            return block;
+        }
+    }
+
+    ESP_LOGD(TAG, "The frame of %zu bytes is allocated on the heap", size);
+
+    return std::malloc(size);
+}
+
+void deallocateFrame(void *frame, size_t) noexcept {
+    {
+        std::lock_guard lock(mutex);
+
+        if (isPooled(frame)) {
+            auto block = static_cast<FreeBlock*>(frame);
+            block->next = freeBlocks;
+            freeBlocks = block;
+            return;
+        }
+    }
+
+    std::free(frame);
+}
+}
@@ -0,0 +1,57 @@
+#include "LoadMonitor.h"
+#include "WorkerPool.h"
+
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace expressif::http::server::detail {
+constexpr static auto relaxed = std::memory_order_relaxed;
+
+// the weight of the new sample is 1 / 2^QueueWaitShift
+constexpr static int QueueWaitShift = 3;
+
+// otherwise the endpoints shed because of a burst would never be called
+// again to bring the average down
+constexpr static uint32_t QueueWaitExpiration = 1000; // ms
+
+static uint32_t getTimeMs() {
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+LoadMonitor::LoadMonitor(const LoadSheddingConfig &config)
+    : m_config(config) {}
+
+void LoadMonitor::recordQueueWait(int64_t wait) {
+    auto sample = std::clamp<int64_t>(wait, 0, std::numeric_limits<int32_t>::max());
+    auto now = getTimeMs();
+    bool isExpired = now - m_lastSampleTime.load(relaxed) > QueueWaitExpiration;
+
+    auto average = m_averageQueueWait.load(relaxed);
+    uint32_t updated;
+
+    do {
+        auto current = static_cast<int64_t>(average);
+        updated = isExpired ? sample : current + ((sample - current) >> QueueWaitShift);
+    } while (!m_averageQueueWait.compare_exchange_weak(average, updated, relaxed));
+
+    m_lastSampleTime.store(now, relaxed);
+}
+
+bool LoadMonitor::isOverloaded(const WorkerPool *workers) const {
+    if (m_config.maxQueuedRequests != 0 && workers != nullptr && workers->getQueuedCount() > m_config.maxQueuedRequests)
+        return true;
+
+    if (m_config.minFreeHeap != 0 && heap_caps_get_free_size(MALLOC_CAP_DEFAULT) < m_config.minFreeHeap)
+        return true;
+
+    if (m_config.maxQueueWait.count() != 0 && getTimeMs() - m_lastSampleTime.load(relaxed) <= QueueWaitExpiration) {
+        auto maxQueueWait = static_cast<uint32_t>(m_config.maxQueueWait.count() * 1000);
+        return m_averageQueueWait.load(relaxed) > maxQueueWait;
+    }
+
+    return false;
+}
+}
@@ -0,0 +1,43 @@
+#ifndef EXPRESSIF_LOADMONITOR_H
+#define EXPRESSIF_LOADMONITOR_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "../../include/expressif/http/server/LoadSheddingConfig.h"
+
+namespace expressif::http::server::detail {
+class WorkerPool;
+
+/**
+ * Tells whether the server is overloaded from the signals which are cheap
+ * to check on every request, see HTTPServer::setLoadShedding.
+ */
+class LoadMonitor {
+public:
+    explicit LoadMonitor(const LoadSheddingConfig &config);
+
+    /**
+     * Updates the moving average of the wait for a worker.
+     * Called by the worker tasks.
+     * @param wait The time the job has spent in the queue (in microseconds)
+     */
+    void recordQueueWait(int64_t wait);
+
+    /**
+     * @param workers The worker pool, nullptr if not started
+     */
+    bool isOverloaded(const WorkerPool *workers) const;
+
+private:
+    LoadSheddingConfig m_config;
+
+    // in microseconds
+    std::atomic<uint32_t> m_averageQueueWait {0};
+
+    // in milliseconds, the average expires if there are no new samples
+    std::atomic<uint32_t> m_lastSampleTime {0};
+};
+}
+
+#endif //EXPRESSIF_LOADMONITOR_H
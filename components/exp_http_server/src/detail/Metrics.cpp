@@ -0,0 +1,244 @@
+#include "Metrics.h"
+
+#if CONFIG_HTTP_SERVER_METRICS
+#include "EndpointData.h"
+
+#include "../../include/expressif/http/server/ChunkWriter.h"
+
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <limits>
+#include <string_view>
+
+namespace expressif::http::server::detail {
+constexpr static auto relaxed = std::memory_order_relaxed;
+
+void EndpointMetrics::record(const char *status, int64_t latency, size_t bytesIn, size_t bytesOut) {
+    auto us = static_cast<uint32_t>(std::clamp<int64_t>(latency, 0, std::numeric_limits<uint32_t>::max()));
+    auto bucket = std::ranges::lower_bound(LatencyBounds, us) - LatencyBounds.begin();
+
+    latencyBuckets[bucket].fetch_add(1, relaxed);
+    latencySum.fetch_add(us, relaxed);
+
+    if (status != nullptr && status[0] >= '1' && status[0] <= '5')
+        statusClasses[status[0] - '1'].fetch_add(1, relaxed);
+
+    this->bytesIn.fetch_add(bytesIn, relaxed);
+    this->bytesOut.fetch_add(bytesOut, relaxed);
+}
+
+static void updateMin(std::atomic<uint32_t> &value, uint32_t candidate) {
+    auto current = value.load(relaxed);
+    while (candidate < current && !value.compare_exchange_weak(current, candidate, relaxed));
+}
+
+static void updateMax(std::atomic<uint32_t> &value, uint32_t candidate) {
+    auto current = value.load(relaxed);
+    while (candidate > current && !value.compare_exchange_weak(current, candidate, relaxed));
+}
+
+ResourceProbe::ResourceProbe()
+    : m_stackMinFree(uxTaskGetStackHighWaterMark(nullptr)),
+      m_freeHeap(heap_caps_get_free_size(MALLOC_CAP_DEFAULT)),
+      m_minFreeHeap(heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT)) {}
+
+void ResourceProbe::record(EndpointMetrics &metrics) const {
+    // in bytes on ESP-IDF; the task is shared with the other endpoints,
+    // only the new minimum is caused by this call
+    if (auto stackMinFree = uxTaskGetStackHighWaterMark(nullptr); stackMinFree < m_stackMinFree)
+        updateMin(metrics.stackMinFree, stackMinFree);
+
+    if (auto freeHeap = heap_caps_get_free_size(MALLOC_CAP_DEFAULT); freeHeap < m_freeHeap)
+        updateMax(metrics.heapMaxRetained, m_freeHeap - freeHeap);
+
+    if (auto minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT); minFreeHeap < m_minFreeHeap)
+        updateMin(metrics.heapMinFree, minFreeHeap);
+}
+
+// e.g. 2500 -> 0.0025
+static void writeSeconds(ChunkWriter &writer, uint64_t us) {
+    char str[32];
+    auto size = snprintf(str, sizeof(str), "%" PRIu64 ".%06" PRIu64, us / 1000000, us % 1000000);
+
+    std::string_view view(str, size);
+    view.remove_suffix(view.size() - view.find_last_not_of('0') - 1);
+
+    if (view.ends_with('.'))
+        view.remove_suffix(1);
+
+    writer.write(view);
+}
+
+static void writeLabels(ChunkWriter &writer, const EndpointData &endpoint) {
+    writer.write("method=\"").write(http_method_str(static_cast<httpd_method_t>(endpoint.method)));
+    writer.write("\",route=\"").write(endpoint.uriTemplate, ChunkWriter::Escape::Json).write('"');
+}
+
+static void writeHeader(ChunkWriter &writer, std::string_view name, std::string_view type, std::string_view help) {
+    writer.write("# HELP ").write(name).write(' ').write(help).write('\n');
+    writer.write("# TYPE ").write(name).write(' ').write(type).write('\n');
+}
+
+template<typename F>
+static void writeCounter(
+    ChunkWriter &writer, const std::vector<std::shared_ptr<EndpointData>> &endpoints,
+    std::string_view name, std::string_view help, F &&get
+) {
+    writeHeader(writer, name, "counter", help);
+
+    for (auto &data : endpoints) {
+        auto &endpoint = *data;
+
+        if (!endpoint.metrics)
+            continue;
+
+        writer.write(name).write('{');
+        writeLabels(writer, endpoint);
+        writer.write("} ").writeNumber(get(*endpoint.metrics).load(relaxed)).write('\n');
+    }
+}
+
+// only the endpoints with EndpointOptions::trackResources
+template<typename F>
+static void writeGauge(
+    ChunkWriter &writer, const std::vector<std::shared_ptr<EndpointData>> &endpoints,
+    std::string_view name, std::string_view help, F &&get
+) {
+    writeHeader(writer, name, "gauge", help);
+
+    for (auto &data : endpoints) {
+        auto &endpoint = *data;
+
+        if (!endpoint.metrics || !endpoint.options.trackResources)
+            continue;
+
+        if (auto value = get(*endpoint.metrics).load(relaxed); value != EndpointMetrics::NotRecorded) {
+            writer.write(name).write('{');
+            writeLabels(writer, endpoint);
+            writer.write("} ").writeNumber(value).write('\n');
+        }
+    }
+}
+
+static void writeLatency(ChunkWriter &writer, const EndpointData &endpoint) {
+    constexpr std::string_view name = "http_request_duration_seconds";
+
+    auto &metrics = *endpoint.metrics;
+    uint32_t count = 0;
+
+    for (size_t i = 0; i < metrics.latencyBuckets.size(); ++i) {
+        count += metrics.latencyBuckets[i].load(relaxed);
+
+        writer.write(name).write("_bucket{");
+        writeLabels(writer, endpoint);
+        writer.write(",le=\"");
+
+        if (i < EndpointMetrics::LatencyBounds.size()) {
+            writeSeconds(writer, EndpointMetrics::LatencyBounds[i]);
+        } else {
+            writer.write("+Inf");
+        }
+
+        writer.write("\"} ").writeNumber(count).write('\n');
+    }
+
+    writer.write(name).write("_sum{");
+    writeLabels(writer, endpoint);
+    writer.write("} ");
+    writeSeconds(writer, metrics.latencySum.load(relaxed));
+    writer.write('\n');
+
+    writer.write(name).write("_count{");
+    writeLabels(writer, endpoint);
+    writer.write("} ").writeNumber(count).write('\n');
+}
+
+static void writeValue(ChunkWriter &writer, std::string_view name, std::string_view type, std::string_view help, uint32_t value) {
+    writeHeader(writer, name, type, help);
+    writer.write(name).write(' ').writeNumber(value).write('\n');
+}
+
+esp_err_t writeMetrics(
+    Response response, const std::vector<std::shared_ptr<EndpointData>> &endpoints,
+    const ServerMetrics &server, const SessionStats &sessions
+) {
+    response.setType("text/plain; version=0.0.4");
+
+    ChunkWriter writer(response);
+
+    writeHeader(writer, "http_requests_total", "counter", "The number of completed requests by status class");
+
+    for (auto &data : endpoints) {
+        auto &endpoint = *data;
+
+        if (!endpoint.metrics)
+            continue;
+
+        for (size_t i = 0; i < EndpointMetrics::StatusClassCount; ++i) {
+            if (auto count = endpoint.metrics->statusClasses[i].load(relaxed); count != 0) {
+                writer.write("http_requests_total{");
+                writeLabels(writer, endpoint);
+                writer.write(",code=\"").writeNumber(i + 1).write("xx\"} ").writeNumber(count).write('\n');
+            }
+        }
+    }
+
+    writeHeader(writer, "http_request_duration_seconds", "histogram", "The time until the request is completed");
+
+    for (auto &endpoint : endpoints) {
+        if (endpoint->metrics) {
+            writeLatency(writer, *endpoint);
+        }
+    }
+
+    writeCounter(writer, endpoints, "http_request_bytes_total", "The size of the request bodies",
+                 [](const EndpointMetrics &metrics) -> auto& { return metrics.bytesIn; });
+
+    writeCounter(writer, endpoints, "http_response_bytes_total", "The size of the response bodies before compression",
+                 [](const EndpointMetrics &metrics) -> auto& { return metrics.bytesOut; });
+
+    writeGauge(writer, endpoints, "http_handler_stack_min_free_bytes",
+               "The free stack of the task at the deepest handler call",
+               [](const EndpointMetrics &metrics) -> auto& { return metrics.stackMinFree; });
+
+    writeGauge(writer, endpoints, "http_handler_heap_min_free_bytes",
+               "The minimum free heap reached during the handler call",
+               [](const EndpointMetrics &metrics) -> auto& { return metrics.heapMinFree; });
+
+    writeGauge(writer, endpoints, "http_handler_heap_max_retained_bytes",
+               "The maximum decrease of the free heap across the handler call",
+               [](const EndpointMetrics &metrics) -> auto& { return metrics.heapMaxRetained; });
+
+    writeValue(writer, "http_not_found_total", "counter",
+               "The number of requests not matching any endpoint", server.notFound.load(relaxed));
+
+    writeValue(writer, "http_error_handler_calls_total", "counter",
+               "The number of calls of the error handlers", server.errorHandlerCalls.load(relaxed));
+
+    writeValue(writer, "http_sessions_active", "gauge", "The number of open connections", sessions.active);
+
+    writeValue(writer, "http_sessions_peak", "gauge",
+               "The maximum number of simultaneously open connections", sessions.peak);
+
+    writeValue(writer, "http_sessions_opened_total", "counter", "The number of accepted connections", sessions.opened);
+
+    writeValue(writer, "http_session_requests_total", "counter", "The number of requests", sessions.requests);
+
+    writeValue(writer, "http_session_reused_requests_total", "counter",
+               "The number of requests received on already used connections", sessions.reusedRequests);
+
+    writeValue(writer, "http_sessions_idle_closed_total", "counter",
+               "The number of connections closed by the idle timeout", sessions.idleClosed);
+
+    writeValue(writer, "http_sessions_lru_purged_total", "counter",
+               "The number of connections closed while all sockets were taken", sessions.lruPurged);
+
+    return writer.finish();
+}
+}
+#endif //CONFIG_HTTP_SERVER_METRICS
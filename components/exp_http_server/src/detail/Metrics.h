@@ -0,0 +1,114 @@
+#ifndef EXPRESSIF_METRICS_H
+#define EXPRESSIF_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../../include/expressif/http/server/Response.h"
+#include "../../include/expressif/http/server/Session.h"
+
+#include "sdkconfig.h"
+
+#if CONFIG_HTTP_SERVER_METRICS
+namespace expressif::http::server::detail {
+class EndpointData;
+
+/**
+ * The counters of a single endpoint, updated by the server, worker and
+ * coroutine tasks without locking.
+ * @note The counters are 32-bit, since wider atomics are not lock-free
+ * on the supported targets. They wrap around, which Prometheus treats
+ * as a counter reset. The latency sum is the exception, see latencySum.
+ */
+class EndpointMetrics {
+public:
+    // the upper bounds of the latency buckets (in microseconds), +Inf is implied
+    constexpr static std::array<uint32_t, 11> LatencyBounds {
+        1'000, 5'000, 10'000, 25'000, 50'000, 100'000,
+        250'000, 500'000, 1'000'000, 2'500'000, 5'000'000
+    };
+
+    // 1xx - 5xx
+    constexpr static size_t StatusClassCount = 5;
+
+public:
+    /**
+     * Records the completed request.
+     * @param status The status line of the response, e.g. "200 OK"
+     * @param latency The time since the request has been received (in microseconds)
+     * @param bytesIn The size of the request body
+     * @param bytesOut The size of the response body written by the handler
+     */
+    void record(const char *status, int64_t latency, size_t bytesIn, size_t bytesOut);
+
+public:
+    // not cumulative, the last one is +Inf
+    std::array<std::atomic<uint32_t>, LatencyBounds.size() + 1> latencyBuckets {};
+
+    // in microseconds; 64-bit, since 32 bits wrap after ~71 minutes of
+    // the total latency, long before the buckets, and the histogram
+    // would become inconsistent
+    std::atomic<uint64_t> latencySum {0};
+
+    std::array<std::atomic<uint32_t>, StatusClassCount> statusClasses {};
+    std::atomic<uint32_t> bytesIn {0};
+    std::atomic<uint32_t> bytesOut {0};
+
+    // see EndpointOptions::trackResources, NotRecorded until the first call
+    constexpr static uint32_t NotRecorded = UINT32_MAX;
+    std::atomic<uint32_t> stackMinFree {NotRecorded};
+    std::atomic<uint32_t> heapMinFree {NotRecorded};
+    std::atomic<uint32_t> heapMaxRetained {0};
+};
+
+/**
+ * Measures the stack and heap usage across the call of the handler.
+ * @see EndpointOptions::trackResources
+ */
+class ResourceProbe {
+public:
+    ResourceProbe();
+
+    /**
+     * Records the usage since the construction:
+     * <ul>
+     *   <li>the stack high-water mark of the calling task, if the call has lowered it</li>
+     *   <li>the heap retained by the call, i.e. the decrease of the free heap</li>
+     *   <li>the minimum free heap, if it has been reached during the call</li>
+     * </ul>
+     * @note The high-water mark is the minimum since the task has started, so
+     * the calls not going deeper than the earlier ones, whichever endpoints
+     * they were made for, are not recorded. The heap is shared: the allocations
+     * of the other tasks running meanwhile are attributed to the call as well.
+     */
+    void record(EndpointMetrics &metrics) const;
+
+private:
+    uint32_t m_stackMinFree;
+    size_t m_freeHeap;
+    size_t m_minFreeHeap;
+};
+
+/**
+ * The counters of the requests not handled by any endpoint.
+ */
+class ServerMetrics {
+public:
+    std::atomic<uint32_t> notFound {0};
+    std::atomic<uint32_t> errorHandlerCalls {0};
+};
+
+/**
+ * Writes the metrics in the Prometheus text exposition format.
+ * @see HTTPServer::writeMetrics
+ */
+esp_err_t writeMetrics(
+        Response response, const std::vector<std::shared_ptr<EndpointData>> &endpoints,
+        const ServerMetrics &server, const SessionStats &sessions);
+}
+#endif //CONFIG_HTTP_SERVER_METRICS
+
+#endif //EXPRESSIF_METRICS_H
@@ -0,0 +1,130 @@
+#include "RateLimiter.h"
+
+#include <esp_timer.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace expressif::http::server::detail {
+constexpr static auto relaxed = std::memory_order_relaxed;
+
+// the number of slots checked for the client, starting from its hash
+constexpr static size_t ProbeCount = std::min<size_t>(8, CONFIG_HTTP_SERVER_RATE_LIMIT_CLIENTS);
+
+// the interval and the tolerance fit into the half of the 32-bit time, see RateLimit
+constexpr static uint32_t MaxTolerance = std::chrono::microseconds(std::chrono::minutes(30)).count();
+
+// FNV-1a
+static uint32_t hash(const uint8_t *data, size_t size) {
+    uint32_t result = 2166136261u;
+
+    for (size_t i = 0; i < size; ++i)
+        result = (result ^ data[i]) * 16777619u;
+
+    return result;
+}
+
+uint32_t RateLimiter::getClientKey(int sockfd) {
+    sockaddr_storage address {};
+    socklen_t size = sizeof(address);
+
+    if (getpeername(sockfd, reinterpret_cast<sockaddr*>(&address), &size) != 0)
+        return 0;
+
+    uint32_t key;
+
+    if (address.ss_family == AF_INET6) {
+        auto &ipv6 = reinterpret_cast<sockaddr_in6&>(address).sin6_addr;
+        key = hash(reinterpret_cast<const uint8_t*>(&ipv6), sizeof(ipv6));
+    } else if (address.ss_family == AF_INET) {
+        auto &ipv4 = reinterpret_cast<sockaddr_in&>(address).sin_addr;
+        key = hash(reinterpret_cast<const uint8_t*>(&ipv4), sizeof(ipv4));
+    } else {
+        return 0;
+    }
+
+    return key != 0 ? key : 1;
+}
+
+RateLimiter::RateLimiter(const RateLimit &limit) {
+    auto period = std::chrono::duration_cast<std::chrono::microseconds>(limit.period).count();
+
+    auto interval = period / std::max<uint32_t>(limit.requests, 1);
+    m_interval = std::clamp<int64_t>(interval, 1, MaxTolerance);
+
+    auto tolerance = static_cast<int64_t>(m_interval) * (std::max<uint32_t>(limit.burst, 1) - 1);
+    m_tolerance = std::min<int64_t>(tolerance, MaxTolerance - m_interval);
+}
+
+uint32_t RateLimiter::getDebt(uint32_t arrivalTime, uint32_t now) const {
+    auto debt = static_cast<int32_t>(arrivalTime - now);
+
+    // the arrival time is never further than the interval and the tolerance
+    // ahead, otherwise the slot has not been used since the time wrapped around
+    if (debt <= 0 || static_cast<uint32_t>(debt) > m_interval + m_tolerance)
+        return 0;
+
+    return debt;
+}
+
+RateLimiter::Slot* RateLimiter::findSlot(uint32_t key, uint32_t now) {
+    auto start = key % m_slots.size();
+    Slot *idle = nullptr;
+
+    for (size_t i = 0; i < ProbeCount; ++i) {
+        auto &slot = m_slots[(start + i) % m_slots.size()];
+        auto slotKey = slot.key.load(std::memory_order_acquire);
+
+        if (slotKey == key)
+            return &slot;
+
+        if (slotKey == 0) {
+            if (slot.key.compare_exchange_strong(slotKey, key, std::memory_order_acq_rel)) {
+                slot.arrivalTime.store(now, relaxed);
+                return &slot;
+            }
+
+            // taken meanwhile, possibly by the same client
+            if (slotKey == key)
+                return &slot;
+        } else if (idle == nullptr && getDebt(slot.arrivalTime.load(relaxed), now) == 0) {
+            idle = &slot;
+        }
+    }
+
+    // the bucket of the idle client is full, so it can be evicted without losing anything
+    if (idle != nullptr) {
+        idle->key.store(key, std::memory_order_release);
+        idle->arrivalTime.store(now, relaxed);
+    }
+
+    return idle;
+}
+
+uint32_t RateLimiter::acquire(uint32_t key) {
+    if (key == 0)
+        return 0;
+
+    auto now = static_cast<uint32_t>(esp_timer_get_time());
+    auto slot = findSlot(key, now);
+
+    if (slot == nullptr)
+        return 0;
+
+    auto arrivalTime = slot->arrivalTime.load(relaxed);
+
+    while (true) {
+        auto debt = getDebt(arrivalTime, now);
+
+        if (debt > m_tolerance)
+            return debt - m_tolerance;
+
+        if (slot->arrivalTime.compare_exchange_weak(arrivalTime, now + debt + m_interval, relaxed)) {
+            return 0;
+        }
+    }
+}
+}
@@ -0,0 +1,56 @@
+#ifndef EXPRESSIF_RATELIMITER_H
+#define EXPRESSIF_RATELIMITER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "../../include/expressif/http/server/RateLimit.h"
+
+#include "sdkconfig.h"
+
+namespace expressif::http::server::detail {
+/**
+ * The generic cell rate algorithm over a fixed-size table of clients.
+ * The table is updated with compare-and-swap, without locking. If the
+ * neighbourhood of the client in the table is taken by the clients with
+ * pending requests, the request is allowed.
+ */
+class RateLimiter {
+public:
+    explicit RateLimiter(const RateLimit &limit);
+
+    /**
+     * Takes a token of the client, if available.
+     * @param key The key of the client, see RateLimiter::getClientKey
+     * @return 0 if the request is allowed, otherwise the time until the next
+     * token is available (in microseconds)
+     */
+    uint32_t acquire(uint32_t key);
+
+    /**
+     * Identifies the client by its address.
+     * @param sockfd The socket of the request
+     * @return The hash of the peer address, 0 if it is unknown
+     */
+    static uint32_t getClientKey(int sockfd);
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> key {0}; // the hash of the address, 0 if free
+        std::atomic<uint32_t> arrivalTime {0}; // the theoretical arrival time (in microseconds)
+    };
+
+    Slot* findSlot(uint32_t key, uint32_t now);
+
+    // how far the theoretical arrival time is ahead of now, 0 for stale slots
+    uint32_t getDebt(uint32_t arrivalTime, uint32_t now) const;
+
+private:
+    uint32_t m_interval; // the emission interval, i.e. the time per token
+    uint32_t m_tolerance; // the burst tolerance
+    std::array<Slot, CONFIG_HTTP_SERVER_RATE_LIMIT_CLIENTS> m_slots;
+};
+}
+
+#endif //EXPRESSIF_RATELIMITER_H
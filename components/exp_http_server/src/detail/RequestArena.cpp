@@ -0,0 +1,42 @@
+#include "RequestArena.h"
+
+#include <mutex>
+
+namespace expressif::http::server::detail {
+// the requests are handled by the server task, the workers and the coroutine task
+static std::mutex mutex;
+static RequestArena *recycled = nullptr;
+static size_t recycledCount = 0;
+
+RequestArena::Ptr RequestArena::acquire() {
+    {
+        std::lock_guard lock(mutex);
+
+        if (auto arena = recycled; arena != nullptr) {
+            recycled = arena->m_next;
+            --recycledCount;
+            return Ptr {arena};
+        }
+    }
+
+    return Ptr {new RequestArena()};
+}
+
+void RequestArena::Releaser::operator()(RequestArena *arena) const {
+    // the heap allocations are freed, the buffer is reused
+    arena->m_resource.release();
+
+    {
+        std::lock_guard lock(mutex);
+
+        if (recycledCount < CONFIG_HTTP_SERVER_ARENA_POOL_SIZE) {
+            arena->m_next = recycled;
+            recycled = arena;
+            ++recycledCount;
+            return;
+        }
+    }
+
+    delete arena;
+}
+}
@@ -0,0 +1,51 @@
+#ifndef EXPRESSIF_REQUESTARENA_H
+#define EXPRESSIF_REQUESTARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+#include "sdkconfig.h"
+
+namespace expressif::http::server::detail {
+/**
+ * The bump allocator backing the allocations made while a request is handled,
+ * see Request::getArena. The arenas are recycled, up to
+ * CONFIG_HTTP_SERVER_ARENA_POOL_SIZE of them, so the heap is not fragmented
+ * by the short-lived allocations. When the arena is exhausted, the memory
+ * is allocated on the heap.
+ */
+class RequestArena {
+public:
+    struct Releaser {
+        void operator()(RequestArena *arena) const;
+    };
+
+    using Ptr = std::unique_ptr<RequestArena, Releaser>;
+
+public:
+    /**
+     * Takes a recycled arena or allocates a new one.
+     */
+    static Ptr acquire();
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    inline std::pmr::memory_resource* getResource() {
+        return &m_resource;
+    }
+
+private:
+    RequestArena() = default;
+
+private:
+    alignas(std::max_align_t) std::byte m_buffer[CONFIG_HTTP_SERVER_ARENA_SIZE];
+    std::pmr::monotonic_buffer_resource m_resource {m_buffer, sizeof(m_buffer), std::pmr::new_delete_resource()};
+
+    // the next recycled arena
+    RequestArena *m_next {nullptr};
+};
+}
+
+#endif //EXPRESSIF_REQUESTARENA_H
@@ -0,0 +1,123 @@
+#ifndef EXPRESSIF_REQUESTCONTEXT_H
+#define EXPRESSIF_REQUESTCONTEXT_H
+
+#include <esp_http_server.h>
+#include <esp_timer.h>
+
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "CompressionFilter.h"
+#include "Metrics.h"
+#include "RequestArena.h"
+#include "ResponseCapture.h"
+#include "SessionManager.h"
+#include "Tracer.h"
+
+namespace expressif::http::server::detail {
+class EndpointData;
+class Coroutine;
+
+/**
+ * Per-request state shared between Request and Response objects.
+ * Stored in httpd_req_t::user_ctx for the duration of the request.
+ */
+class RequestContext {
+public:
+    explicit RequestContext(EndpointData *endpoint = nullptr)
+        : arena(RequestArena::acquire()),
+          endpoint(endpoint),
+          headers(getArena()) {}
+
+    RequestContext(const RequestContext&) = delete;
+    RequestContext& operator=(const RequestContext&) = delete;
+
+    // the arena is not relocated, see Request::detach
+    RequestContext(RequestContext&&) = default;
+
+#if CONFIG_HTTP_SERVER_METRICS
+    // the request ends with its context, see AsyncRequest::complete
+    ~RequestContext() {
+        // moved-from contexts have no metrics
+        if (metrics) {
+            metrics->record(status, esp_timer_get_time() - startTime, bytesIn, bytesOut);
+        }
+    }
+#endif
+
+    inline static RequestContext* of(httpd_req_t *req) {
+        return req != nullptr ? static_cast<RequestContext*>(req->user_ctx) : nullptr;
+    }
+
+    /**
+     * @see Request::getArena
+     */
+    inline std::pmr::memory_resource* getArena() {
+        return arena->getResource();
+    }
+
+    /**
+     * Keeps a copy of the value alive until the request ends.
+     * @note Only pointers to the header values are stored, see headers,
+     * so they must outlive the response.
+     * @param value The value to be stored
+     * @return The pointer to the stored null-terminated value
+     */
+    inline const char* store(std::string_view value) {
+        auto copy = static_cast<char*>(getArena()->allocate(value.size() + 1, alignof(char)));
+        std::memcpy(copy, value.data(), value.size());
+        copy[value.size()] = '\0';
+        return copy;
+    }
+
+public:
+    // declared first: the other members may be allocated from it
+    RequestArena::Ptr arena;
+
+    EndpointData *endpoint;
+
+    // the head of the response, composed by detail::formatHead
+    const char *status {HTTPD_200};
+    const char *type {HTTPD_TYPE_TEXT};
+    std::pmr::vector<std::pair<const char*, const char*>> headers;
+
+    // the head cannot be changed anymore
+    bool isHeadSent {false};
+
+    // fixed-length mode, see Response::setContentLength
+    bool isFixedLength {false};
+    size_t remainingLength {0};
+
+#if CONFIG_HTTP_SERVER_COMPRESSION
+    std::unique_ptr<CompressionFilter> compression;
+#endif
+
+    // set if the response is going to be cached
+    std::unique_ptr<ResponseCapture> capture;
+
+    // set if the request is handled by a coroutine endpoint
+    Coroutine *coroutine {nullptr};
+
+    // the session is idle again once the context is destroyed
+    std::unique_ptr<Session, SessionRequestEnd> session;
+
+#if CONFIG_HTTP_SERVER_METRICS
+    // set if the request is handled by an endpoint
+    std::shared_ptr<EndpointMetrics> metrics;
+    int64_t startTime {0};
+    size_t bytesIn {0};
+
+    // the size of the body written by the handler, see Response::writeChunk
+    size_t bytesOut {0};
+#endif
+
+    // ends with the request, the other spans of the request are nested;
+    // takes no space if CONFIG_HTTP_SERVER_TRACING is disabled
+    [[no_unique_address]] TraceSpan span;
+};
+}
+
+#endif //EXPRESSIF_REQUESTCONTEXT_H
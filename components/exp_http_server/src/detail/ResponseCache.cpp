@@ -0,0 +1,194 @@
+#include "ResponseCache.h"
+#include "StringUtils.h"
+
+#include <expressif/http/server/util/HTTPDate.h>
+
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace expressif::http::server::detail {
+size_t ResponseCache::Entry::size() const {
+    auto result = sizeof(Entry) + key.size() + uriTemplate.size() + type.size() +
+                  validators.etag.size() + body.size();
+
+    for (auto &[name, value] : headers)
+        result += sizeof(headers[0]) + name.size() + value.size();
+
+    return result;
+}
+
+ResponseCache::ResponseCache(size_t capacity, size_t maxEntrySize)
+    : m_capacity(capacity),
+      m_maxEntrySize(maxEntrySize) {}
+
+ResponseCache::EntryPtr ResponseCache::find(std::string_view key) {
+    std::lock_guard lock(m_mutex);
+
+    auto it = m_index.find(key);
+
+    if (it == m_index.end())
+        return nullptr;
+
+    if (auto entryIt = it->second; (*entryIt)->expiresAt <= esp_timer_get_time()) {
+        erase(entryIt);
+        return nullptr;
+    } else {
+        m_entries.splice(m_entries.begin(), m_entries, entryIt);
+        return *entryIt;
+    }
+}
+
+void ResponseCache::store(
+    std::string key, std::string_view uriTemplate,
+    const CachePolicy &policy, RequestContext &context
+) {
+    auto &capture = context.capture;
+
+    if (!capture || !capture->isComplete || capture->isOverflowed || strcmp(context.status, HTTPD_200) != 0)
+        return;
+
+    auto entry = std::make_shared<Entry>();
+    entry->key = std::move(key);
+    entry->uriTemplate = uriTemplate;
+    entry->expiresAt = esp_timer_get_time() + std::chrono::microseconds(policy.ttl).count();
+    entry->type = context.type;
+    entry->compressionMinSize = capture->compressionMinSize;
+
+    for (auto &[name, value] : context.headers) {
+        if (equalsIgnoreCase(name, "Set-Cookie"))
+            return;
+
+        if (equalsIgnoreCase(name, "Cache-Control") && strstr(value, "no-store") != nullptr)
+            return;
+
+        if (equalsIgnoreCase(name, "ETag")) {
+            entry->validators.etag = value;
+        } else if (equalsIgnoreCase(name, "Last-Modified")) {
+            entry->validators.lastModified = HTTPDate::parse(value).value_or(0);
+        }
+
+        // set again when the entry is served
+        if (equalsIgnoreCase(name, "Accept-Ranges"))
+            continue;
+
+        // the body is captured uncompressed, the encoding is negotiated again when served
+        if (entry->compressionMinSize != 0 && equalsIgnoreCase(name, "Content-Encoding"))
+            continue;
+
+        if (entry->compressionMinSize != 0 && equalsIgnoreCase(name, "Vary") && equalsIgnoreCase(value, "Accept-Encoding"))
+            continue;
+
+        entry->headers.emplace_back(name, value);
+    }
+
+    entry->body = std::move(capture->body);
+
+    auto size = entry->size();
+
+    if (size > m_capacity)
+        return;
+
+    std::lock_guard lock(m_mutex);
+
+    if (auto it = m_index.find(entry->key); it != m_index.end())
+        erase(it->second);
+
+    // evict the least recently used entries
+    while (m_size + size > m_capacity)
+        erase(std::prev(m_entries.end()));
+
+    m_entries.emplace_front(std::move(entry));
+    m_index.emplace(m_entries.front()->key, m_entries.begin());
+    m_size += size;
+}
+
+void ResponseCache::invalidate(std::string_view uriTemplate) {
+    std::lock_guard lock(m_mutex);
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        auto next = std::next(it);
+
+        if ((*it)->uriTemplate == uriTemplate)
+            erase(it);
+
+        it = next;
+    }
+}
+
+void ResponseCache::clear() {
+    std::lock_guard lock(m_mutex);
+
+    m_index.clear();
+    m_entries.clear();
+    m_size = 0;
+}
+
+size_t ResponseCache::getMaxEntrySize() const {
+    return m_maxEntrySize;
+}
+
+static void appendNormalized(std::string &out, std::string_view str) {
+    for (size_t i = 0; i < str.size(); ++i) {
+        out += str[i];
+
+        // %2f and %2F are equivalent
+        if (str[i] == '%' && i + 2 < str.size()) {
+            out += static_cast<char>(toupper(str[i + 1]));
+            out += static_cast<char>(toupper(str[i + 2]));
+            i += 2;
+        }
+    }
+}
+
+std::string ResponseCache::makeKey(httpd_req_t *req, const CachePolicy &policy) {
+    std::string_view uri = req->uri;
+    std::string_view path = uri.substr(0, uri.find_first_of("?#"));
+
+    std::string key = http_method_str(static_cast<http_method>(req->method));
+    key += ' ';
+
+    appendNormalized(key, path);
+
+    if (auto queryBegin = uri.find('?'); queryBegin != std::string_view::npos) {
+        auto query = uri.substr(queryBegin + 1);
+        query = query.substr(0, query.find('#'));
+
+        std::vector<std::string_view> params;
+
+        while (!query.empty()) {
+            auto end = query.find('&');
+
+            if (auto param = query.substr(0, end); !param.empty())
+                params.emplace_back(param);
+
+            query = end == std::string_view::npos ? std::string_view {} : query.substr(end + 1);
+        }
+
+        std::ranges::sort(params);
+
+        for (size_t i = 0; i < params.size(); ++i) {
+            key += i == 0 ? '?' : '&';
+            appendNormalized(key, params[i]);
+        }
+    }
+
+    for (auto &name : policy.keyHeaders) {
+        auto size = httpd_req_get_hdr_value_len(req, name.c_str());
+        std::string value(size, '\0');
+        httpd_req_get_hdr_value_str(req, name.c_str(), value.data(), size + 1);
+
+        key.append("\n").append(name).append(": ").append(value);
+    }
+
+    return key;
+}
+
+void ResponseCache::erase(std::list<EntryPtr>::iterator it) {
+    m_size -= (*it)->size();
+    m_index.erase((*it)->key);
+    m_entries.erase(it);
+}
+}
@@ -0,0 +1,95 @@
+#ifndef EXPRESSIF_RESPONSECACHE_H
+#define EXPRESSIF_RESPONSECACHE_H
+
+#include <esp_http_server.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../../include/expressif/http/server/EndpointOptions.h"
+#include "../../include/expressif/http/server/Validators.h"
+#include "RequestContext.h"
+#include "ResponseCapture.h"
+
+namespace expressif::http::server::detail {
+/**
+ * Bounded LRU store of the responses of the endpoints with
+ * EndpointOptions::cache. Thread-safe.
+ */
+class ResponseCache {
+public:
+    struct Entry {
+        std::string key;
+        std::string uriTemplate;
+
+        // esp_timer_get_time() based, in microseconds
+        int64_t expiresAt;
+
+        std::string type;
+        std::vector<std::pair<std::string, std::string>> headers;
+        Validators validators;
+        ResponseCapture::Body body;
+        size_t compressionMinSize;
+
+        size_t size() const;
+    };
+
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+public:
+    ResponseCache(size_t capacity, size_t maxEntrySize);
+
+    /**
+     * @return The entry if it exists and has not expired yet, nullptr otherwise
+     */
+    EntryPtr find(std::string_view key);
+
+    /**
+     * Stores the response recorded in the context if it is cacheable.
+     * @param key The key, see ResponseCache::makeKey
+     * @param uriTemplate The template of the endpoint
+     * @param policy The caching policy of the endpoint
+     * @param context The context of the finished request
+     */
+    void store(std::string key, std::string_view uriTemplate, const CachePolicy &policy, RequestContext &context);
+
+    /**
+     * Removes the entries of the endpoint.
+     */
+    void invalidate(std::string_view uriTemplate);
+
+    void clear();
+
+    size_t getMaxEntrySize() const;
+
+    /**
+     * Composes the key: the method, the normalized URI (uppercase percent-encoding,
+     * query parameters in the lexicographical order) and the key headers.
+     */
+    static std::string makeKey(httpd_req_t *req, const CachePolicy &policy);
+
+private:
+    void erase(std::list<EntryPtr>::iterator it);
+
+private:
+    std::mutex m_mutex;
+
+    // the most recently used entries first
+    std::list<EntryPtr> m_entries;
+
+    // the keys point to Entry::key
+    std::unordered_map<std::string_view, std::list<EntryPtr>::iterator> m_index;
+
+    size_t m_size {0};
+    size_t m_capacity;
+    size_t m_maxEntrySize;
+};
+}
+
+#endif //EXPRESSIF_RESPONSECACHE_H
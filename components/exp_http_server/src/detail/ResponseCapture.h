@@ -0,0 +1,50 @@
+#ifndef EXPRESSIF_RESPONSECAPTURE_H
+#define EXPRESSIF_RESPONSECAPTURE_H
+
+#include <vector>
+
+#include "../../include/expressif/http/server/Buffer.h"
+#include "SpiramAllocator.h"
+
+namespace expressif::http::server::detail {
+/**
+ * Records the body written by the handler, so the response can be cached.
+ * @see ResponseCache
+ */
+class ResponseCapture {
+public:
+    using Body = std::vector<byte_t, SpiramAllocator<byte_t>>;
+
+public:
+    explicit ResponseCapture(size_t maxSize)
+        : m_maxSize(maxSize) {}
+
+    inline void append(ConstBuffer data) {
+        if (isOverflowed)
+            return;
+
+        if (data.size() > m_maxSize - body.size()) {
+            // too big to be cached, do not waste memory anymore
+            isOverflowed = true;
+            Body().swap(body);
+            return;
+        }
+
+        body.insert(body.end(), data.begin(), data.end());
+    }
+
+public:
+    Body body;
+
+    bool isOverflowed {false};
+    bool isComplete {false};
+
+    // 0 if the compression is disabled
+    size_t compressionMinSize {0};
+
+private:
+    size_t m_maxSize;
+};
+}
+
+#endif //EXPRESSIF_RESPONSECAPTURE_H
@@ -0,0 +1,107 @@
+#include "ResponseWriter.h"
+#include "RequestContext.h"
+
+#include <charconv>
+#include <string_view>
+
+namespace expressif::http::server::detail {
+std::pmr::string formatHead(RequestContext &context, Framing framing, size_t length) {
+    std::pmr::string head(context.getArena());
+    head.reserve(128);
+
+    auto appendHeader = [&head](std::string_view name, std::string_view value) {
+        head.append(name).append(": ").append(value).append("\r\n");
+    };
+
+    head.append("HTTP/1.1 ").append(context.status).append("\r\n");
+
+    // 304 has no content, see Response::notModified
+    if (context.type != nullptr)
+        appendHeader("Content-Type", context.type);
+
+    switch (framing) {
+        case Framing::Length: {
+            char value[24];
+            auto end = std::to_chars(value, value + sizeof(value), length).ptr;
+            appendHeader("Content-Length", {value, end});
+            break;
+        }
+
+        case Framing::Chunked:
+            appendHeader("Transfer-Encoding", "chunked");
+            break;
+
+        case Framing::None:
+            break;
+    }
+
+    for (auto &[name, value] : context.headers)
+        appendHeader(name, value);
+
+    head.append("\r\n");
+
+    return head;
+}
+
+esp_err_t sendHead(httpd_req_t *req, Framing framing, size_t length) {
+    auto context = RequestContext::of(req);
+
+    if (context == nullptr || context->isHeadSent)
+        return ESP_ERR_INVALID_STATE;
+
+    context->isHeadSent = true;
+
+    return sendAll(req, toBuffer(formatHead(*context, framing, length)));
+}
+
+esp_err_t sendAll(httpd_req_t *req, ConstBuffer data) {
+    auto buff = reinterpret_cast<const char*>(data.data());
+    auto size = data.size();
+
+    while (size > 0) {
+        if (int n = httpd_send(req, buff, size); n < 0) {
+            return n == HTTPD_SOCK_ERR_TIMEOUT ? ESP_ERR_TIMEOUT : ESP_FAIL;
+        } else {
+            buff += n;
+            size -= n;
+        }
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t sendChunkHead(httpd_req_t *req) {
+    if (auto context = RequestContext::of(req); context != nullptr && !context->isHeadSent)
+        return sendHead(req, Framing::Chunked);
+
+    return ESP_OK;
+}
+
+esp_err_t sendChunk(httpd_req_t *req, ConstBuffer chunk) {
+    if (chunk.empty())
+        return ESP_OK;
+
+    if (auto ret = sendChunkHead(req); ret != ESP_OK)
+        return ret;
+
+    char size[20];
+    auto end = std::to_chars(size, size + sizeof(size) - 2, chunk.size(), 16).ptr;
+    *end++ = '\r';
+    *end++ = '\n';
+
+    if (auto ret = sendAll(req, toBuffer(std::string_view {size, end})); ret != ESP_OK)
+        return ret;
+
+    if (auto ret = sendAll(req, chunk); ret != ESP_OK)
+        return ret;
+
+    return sendAll(req, toBuffer("\r\n"));
+}
+
+esp_err_t sendLastChunk(httpd_req_t *req) {
+    if (auto ret = sendChunkHead(req); ret != ESP_OK)
+        return ret;
+
+    return sendAll(req, toBuffer("0\r\n\r\n"));
+}
+}
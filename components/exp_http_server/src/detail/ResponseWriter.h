@@ -0,0 +1,54 @@
+#ifndef EXPRESSIF_RESPONSEWRITER_H
+#define EXPRESSIF_RESPONSEWRITER_H
+
+#include <esp_http_server.h>
+
+#include <memory_resource>
+
+#include "../../include/expressif/http/server/Buffer.h"
+
+namespace expressif::http::server::detail {
+class RequestContext;
+
+/**
+ * How the client finds the end of the body.
+ */
+enum class Framing {
+    Length,  // Content-Length
+    Chunked, // Transfer-Encoding: chunked
+    None     // no body (304) or until the connection is closed (event streams)
+};
+
+/**
+ * Composes the head of the response from the status, the type and the
+ * headers stored in the context. All the responses are composed here,
+ * esp_http_server composes none of them.
+ * @param context The context of the request, the head is allocated from its arena
+ * @param framing How the end of the body is determined
+ * @param length The value of `Content-Length`, Framing::Length only
+ */
+std::pmr::string formatHead(RequestContext &context, Framing framing, size_t length = 0);
+
+/**
+ * Sends the head, see formatHead.
+ */
+esp_err_t sendHead(httpd_req_t *req, Framing framing, size_t length = 0);
+
+/**
+ * Sends the data as is, retrying the partial sends.
+ */
+esp_err_t sendAll(httpd_req_t *req, ConstBuffer data);
+
+/**
+ * Sends the chunk in the chunked transfer encoding, preceded by the head
+ * if it has not been sent yet. Empty chunks are skipped.
+ */
+esp_err_t sendChunk(httpd_req_t *req, ConstBuffer chunk);
+
+/**
+ * Sends the terminating chunk, preceded by the head if it has not been sent yet.
+ */
+esp_err_t sendLastChunk(httpd_req_t *req);
+}
+
+#endif //EXPRESSIF_RESPONSEWRITER_H
@@ -0,0 +1,226 @@
+#include "SessionManager.h"
+
+#include <esp_log.h>
+
+#include <memory>
+
+namespace expressif::http::server::detail {
+constexpr static auto TAG = "expressif::http::server::SessionManager";
+
+constexpr static auto relaxed = std::memory_order_relaxed;
+
+// the granularity of SessionConfig::idleTimeout
+constexpr static uint64_t CheckInterval = 1000000; // us
+
+namespace {
+struct CloseWork {
+    httpd_handle_t handle;
+    int sockfd;
+    const Session *session;
+};
+}
+
+static uint32_t getTimeMs() {
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+SessionManager::SessionManager() {
+    setConfig({});
+}
+
+SessionManager::~SessionManager() {
+    stop();
+}
+
+void SessionManager::setConfig(const SessionConfig &config) {
+    m_idleTimeout.store(config.idleTimeout.count(), relaxed);
+    m_maxRequests.store(config.maxRequests, relaxed);
+}
+
+esp_err_t SessionManager::start(httpd_handle_t handle, size_t maxSessions, bool isPurged) {
+    std::lock_guard lock(m_mutex);
+
+    if (m_timer == nullptr) {
+        esp_timer_create_args_t args {
+            .callback = onTimer,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "http_sessions",
+            .skip_unhandled_events = true
+        };
+
+        if (auto ret = esp_timer_create(&args, &m_timer); ret != ESP_OK)
+            return ret;
+    }
+
+    m_handle = handle;
+    m_clients.resize(maxSessions);
+    m_isPurged = isPurged;
+
+    // the check queued before the server was stopped is dropped
+    m_isCheckQueued.store(false, relaxed);
+
+    return esp_timer_start_periodic(m_timer, CheckInterval);
+}
+
+void SessionManager::stop() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_handle = nullptr;
+    }
+
+    if (m_timer != nullptr) {
+        esp_timer_stop(m_timer);
+        esp_timer_delete(m_timer);
+        m_timer = nullptr;
+    }
+}
+
+Session& SessionManager::open(httpd_handle_t handle, int sockfd) {
+    auto session = new Session(handle, sockfd, std::chrono::milliseconds(m_idleTimeout.load(relaxed)));
+
+    httpd_sess_set_ctx(handle, sockfd, session, [](void *ctx) {
+        delete static_cast<Session*>(ctx);
+    });
+
+    m_opened.fetch_add(1, relaxed);
+
+    auto active = m_active.fetch_add(1, relaxed) + 1;
+    auto peak = m_peak.load(relaxed);
+    while (active > peak && !m_peak.compare_exchange_weak(peak, active, relaxed));
+
+    return *session;
+}
+
+void SessionManager::close(Session &session) {
+    auto active = m_active.fetch_sub(1, relaxed);
+
+    // esp_http_server does not tell why the session is closed
+    std::lock_guard lock(m_mutex);
+
+    if (m_isPurged && m_handle != nullptr && active >= m_clients.size() && !session.m_isClosing.load(relaxed)) {
+        m_lruPurged.fetch_add(1, relaxed);
+    }
+}
+
+bool SessionManager::beginRequest(Session &session) {
+    session.m_isBusy.store(true, relaxed);
+    session.m_lastActive.store(getTimeMs(), relaxed);
+
+    m_requests.fetch_add(1, relaxed);
+
+    if (++session.m_requestCount > 1)
+        m_reusedRequests.fetch_add(1, relaxed);
+
+    auto maxRequests = m_maxRequests.load(relaxed);
+
+    if (maxRequests != 0 && session.m_requestCount >= maxRequests) {
+        session.m_isClosing.store(true, relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+void SessionManager::endRequest(Session &session) {
+    auto handle = session.m_handle;
+    auto sockfd = session.m_socket;
+    auto isClosing = session.m_isClosing.load(relaxed);
+
+    session.m_lastActive.store(getTimeMs(), relaxed);
+
+    // the session may be closed and freed by the server task from now on
+    session.m_isBusy.store(false, std::memory_order_release);
+
+    if (!isClosing)
+        return;
+
+    // the socket may have been closed and reused meanwhile, the server task
+    // closes it only if it still belongs to the same session
+    auto work = new CloseWork {handle, sockfd, &session};
+
+    auto ret = httpd_queue_work(handle, [](void *arg) {
+        std::unique_ptr<CloseWork> work(static_cast<CloseWork*>(arg));
+
+        if (httpd_sess_get_ctx(work->handle, work->sockfd) == work->session) {
+            httpd_sess_trigger_close(work->handle, work->sockfd);
+        }
+    }, work);
+
+    if (ret != ESP_OK) {
+        delete work;
+    }
+}
+
+void SessionManager::keepOpen(Session &session) {
+    session.m_isClosing.store(false, relaxed);
+}
+
+void SessionManager::onTimer(void *arg) {
+    auto self = static_cast<SessionManager*>(arg);
+
+    std::lock_guard lock(self->m_mutex);
+
+    if (self->m_handle == nullptr || self->m_isCheckQueued.exchange(true, relaxed))
+        return;
+
+    if (httpd_queue_work(self->m_handle, closeIdle, self) != ESP_OK) {
+        self->m_isCheckQueued.store(false, relaxed);
+    }
+}
+
+void SessionManager::closeIdle(void *arg) {
+    auto self = static_cast<SessionManager*>(arg);
+    self->m_isCheckQueued.store(false, relaxed);
+
+    httpd_handle_t handle;
+
+    {
+        std::lock_guard lock(self->m_mutex);
+        handle = self->m_handle;
+    }
+
+    if (handle == nullptr)
+        return;
+
+    size_t count = self->m_clients.size();
+
+    if (httpd_get_client_list(handle, &count, self->m_clients.data()) != ESP_OK)
+        return;
+
+    auto now = getTimeMs();
+
+    for (size_t i = 0; i < count; ++i) {
+        auto sockfd = self->m_clients[i];
+        auto session = static_cast<Session*>(httpd_sess_get_ctx(handle, sockfd));
+
+        if (session == nullptr || session->m_isClosing.load(relaxed) || !session->isIdle(now))
+            continue;
+
+#if CONFIG_HTTPD_WS_SUPPORT
+        // the WebSocket connections stay open without requests
+        if (httpd_ws_get_fd_info(handle, sockfd) == HTTPD_WS_CLIENT_WEBSOCKET)
+            continue;
+#endif
+
+        session->m_isClosing.store(true, relaxed);
+
+        if (httpd_sess_trigger_close(handle, sockfd) == ESP_OK) {
+            ESP_LOGD(TAG, "Session %i is idle, closing", sockfd);
+            self->m_idleClosed.fetch_add(1, relaxed);
+        }
+    }
+}
+
+SessionStats SessionManager::getStats() const {
+    return {
+        .active = m_active.load(relaxed),
+        .peak = m_peak.load(relaxed),
+        .opened = m_opened.load(relaxed),
+        .requests = m_requests.load(relaxed),
+        .reusedRequests = m_reusedRequests.load(relaxed),
+        .idleClosed = m_idleClosed.load(relaxed),
+        .lruPurged = m_lruPurged.load(relaxed)
+    };
+}
+}
@@ -0,0 +1,112 @@
+#ifndef EXPRESSIF_SESSIONMANAGER_H
+#define EXPRESSIF_SESSIONMANAGER_H
+
+#include <esp_http_server.h>
+#include <esp_timer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "../../include/expressif/http/server/Session.h"
+#include "../../include/expressif/http/server/SessionConfig.h"
+
+namespace expressif::http::server::detail {
+/**
+ * Creates the sessions of the accepted connections, counts them and closes
+ * the idle ones. Called by the server task, except the end of the requests
+ * and the statistics.
+ */
+class SessionManager {
+public:
+    SessionManager();
+    ~SessionManager();
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    void setConfig(const SessionConfig &config);
+
+    /**
+     * Starts checking the idle sessions of the server.
+     * @param handle The started server
+     * @param maxSessions Config::max_open_sockets
+     * @param isPurged Config::lru_purge_enable
+     */
+    esp_err_t start(httpd_handle_t handle, size_t maxSessions, bool isPurged);
+
+    /**
+     * Stops checking the idle sessions, must be called before httpd_stop.
+     */
+    void stop();
+
+    /**
+     * Creates the session of the accepted connection, stored in its
+     * `sess_ctx` and freed by esp_http_server when it is closed.
+     */
+    Session& open(httpd_handle_t handle, int sockfd);
+
+    void close(Session &session);
+
+    /**
+     * Counts the request of the session.
+     * @return `true` if it is the last request of the connection,
+     * see SessionConfig::maxRequests
+     */
+    bool beginRequest(Session &session);
+
+    /**
+     * Closes the connection after its last request, called by the task
+     * the request ends in.
+     */
+    static void endRequest(Session &session);
+
+    /**
+     * Keeps the connection open after the current request, despite
+     * SessionConfig::maxRequests, e.g. for the event streams.
+     */
+    static void keepOpen(Session &session);
+
+    SessionStats getStats() const;
+
+private:
+    static void onTimer(void *arg);
+
+    // in the server task
+    static void closeIdle(void *arg);
+
+private:
+    std::atomic<uint32_t> m_idleTimeout; // ms
+    std::atomic<uint32_t> m_maxRequests;
+
+    // guards m_handle: the timer may fire while the server is being stopped
+    std::mutex m_mutex;
+    httpd_handle_t m_handle {nullptr};
+    esp_timer_handle_t m_timer {nullptr};
+    std::atomic<bool> m_isCheckQueued {false};
+
+    // the buffer of httpd_get_client_list
+    std::vector<int> m_clients;
+    bool m_isPurged {false};
+
+    std::atomic<uint32_t> m_active {0};
+    std::atomic<uint32_t> m_peak {0};
+    std::atomic<uint32_t> m_opened {0};
+    std::atomic<uint32_t> m_requests {0};
+    std::atomic<uint32_t> m_reusedRequests {0};
+    std::atomic<uint32_t> m_idleClosed {0};
+    std::atomic<uint32_t> m_lruPurged {0};
+};
+
+/**
+ * Ends the request of the session, see RequestContext::session.
+ */
+struct SessionRequestEnd {
+    void operator()(Session *session) const {
+        SessionManager::endRequest(*session);
+    }
+};
+}
+
+#endif //EXPRESSIF_SESSIONMANAGER_H
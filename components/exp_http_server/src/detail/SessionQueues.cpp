@@ -0,0 +1,138 @@
+#include "SessionQueues.h"
+
+#include <esp_log.h>
+
+#include <algorithm>
+
+namespace expressif::http::server::detail {
+constexpr static auto TAG = "expressif::http::server::SessionQueues";
+
+namespace {
+struct DrainWork {
+    std::weak_ptr<SessionQueues> queues;
+    int sockfd;
+};
+}
+
+SessionQueues::SessionQueues(size_t capacity)
+    : m_capacity(capacity) {}
+
+void SessionQueues::add(httpd_handle_t handle, int sockfd) {
+    std::lock_guard lock(m_mutex);
+    m_sessions.push_back({sockfd, handle, {}, false});
+}
+
+bool SessionQueues::remove(int sockfd) {
+    std::lock_guard lock(m_mutex);
+
+    auto it = std::ranges::find(m_sessions, sockfd, &Session::sockfd);
+
+    if (it == m_sessions.end())
+        return false;
+
+    m_sessions.erase(it);
+
+    return true;
+}
+
+bool SessionQueues::push(int sockfd, const Message &message) {
+    std::lock_guard lock(m_mutex);
+
+    auto it = std::ranges::find(m_sessions, sockfd, &Session::sockfd);
+
+    return it != m_sessions.end() && enqueue(*it, message);
+}
+
+size_t SessionQueues::pushAll(const Message &message) {
+    std::lock_guard lock(m_mutex);
+
+    return std::ranges::count_if(m_sessions, [&](Session &session) {
+        return enqueue(session, message);
+    });
+}
+
+size_t SessionQueues::size() const {
+    std::lock_guard lock(m_mutex);
+    return m_sessions.size();
+}
+
+std::vector<int> SessionQueues::getSockets() const {
+    std::lock_guard lock(m_mutex);
+
+    std::vector<int> sockets;
+    sockets.reserve(m_sessions.size());
+
+    for (auto &session : m_sessions)
+        sockets.emplace_back(session.sockfd);
+
+    return sockets;
+}
+
+bool SessionQueues::enqueue(Session &session, const Message &message) {
+    if (session.queue.size() == m_capacity) {
+        ESP_LOGD(TAG, "Session %i is too slow, the oldest message is dropped", session.sockfd);
+        session.queue.pop_front();
+    }
+
+    session.queue.push_back(message);
+
+    if (session.isScheduled)
+        return true;
+
+    auto work = new DrainWork {weak_from_this(), session.sockfd};
+
+    if (httpd_queue_work(session.handle, drain, work) != ESP_OK) {
+        delete work;
+        session.queue.clear();
+        return false;
+    }
+
+    session.isScheduled = true;
+
+    return true;
+}
+
+void SessionQueues::drain(void *arg) {
+    std::unique_ptr<DrainWork> work(static_cast<DrainWork*>(arg));
+
+    auto self = work->queues.lock();
+
+    if (!self)
+        return;
+
+    while (true) {
+        Message message;
+        httpd_handle_t handle;
+
+        {
+            std::lock_guard lock(self->m_mutex);
+
+            auto session = std::ranges::find(self->m_sessions, work->sockfd, &Session::sockfd);
+
+            if (session == self->m_sessions.end())
+                return;
+
+            if (session->queue.empty()) {
+                session->isScheduled = false;
+                return;
+            }
+
+            message = std::move(session->queue.front());
+            session->queue.pop_front();
+            handle = session->handle;
+        }
+
+        for (size_t sent = 0; sent < message->size();) {
+            int n = httpd_socket_send(handle, work->sockfd, message->data() + sent, message->size() - sent, 0);
+
+            if (n < 0) {
+                // the session will be removed from the close callback
+                httpd_sess_trigger_close(handle, work->sockfd);
+                return;
+            }
+
+            sent += n;
+        }
+    }
+}
+}
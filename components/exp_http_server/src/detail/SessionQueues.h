@@ -0,0 +1,70 @@
+#ifndef EXPRESSIF_SESSIONQUEUES_H
+#define EXPRESSIF_SESSIONQUEUES_H
+
+#include <esp_http_server.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace expressif::http::server::detail {
+/**
+ * Bounded per-session queues of preformatted messages, sent asynchronously
+ * by the server task via `httpd_queue_work`. The messages are shared, so
+ * a broadcast message is serialized only once. If a session cannot keep up,
+ * its oldest messages are dropped. Thread-safe.
+ * @see EventSource, WebSocket
+ */
+class SessionQueues : public std::enable_shared_from_this<SessionQueues> {
+public:
+    using Message = std::shared_ptr<const std::string>;
+
+public:
+    explicit SessionQueues(size_t capacity);
+
+    void add(httpd_handle_t handle, int sockfd);
+
+    /**
+     * @return `true` if the session has been removed
+     */
+    bool remove(int sockfd);
+
+    /**
+     * @return `false` if there is no such session or the message cannot be queued
+     */
+    bool push(int sockfd, const Message &message);
+
+    /**
+     * @return The number of sessions the message has been queued for
+     */
+    size_t pushAll(const Message &message);
+
+    size_t size() const;
+
+    std::vector<int> getSockets() const;
+
+private:
+    struct Session {
+        int sockfd;
+        httpd_handle_t handle;
+        std::deque<Message> queue;
+        bool isScheduled;
+    };
+
+private:
+    // must be called with the locked mutex
+    bool enqueue(Session &session, const Message &message);
+
+    // sends the queued messages, runs in the server task
+    static void drain(void *arg);
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Session> m_sessions;
+    size_t m_capacity;
+};
+}
+
+#endif //EXPRESSIF_SESSIONQUEUES_H
@@ -0,0 +1,63 @@
+#include "SocketTuning.h"
+
+#include <esp_log.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+namespace expressif::http::server::detail {
+constexpr static auto TAG = "expressif::http::server::SocketTuning";
+
+static void setOption(int sockfd, int level, int name, const void *value, socklen_t size, const char *label) {
+    if (setsockopt(sockfd, level, name, value, size) != 0) {
+        ESP_LOGD(TAG, "Cannot set %s of socket %i", label, sockfd);
+    }
+}
+
+static void setInt(int sockfd, int level, int name, int value, const char *label) {
+    setOption(sockfd, level, name, &value, sizeof(value), label);
+}
+
+static void setTimeout(int sockfd, int name, std::chrono::milliseconds timeout, const char *label) {
+    timeval value {
+        .tv_sec = static_cast<decltype(timeval::tv_sec)>(timeout.count() / 1000),
+        .tv_usec = static_cast<decltype(timeval::tv_usec)>(timeout.count() % 1000 * 1000)
+    };
+
+    setOption(sockfd, SOL_SOCKET, name, &value, sizeof(value), label);
+}
+
+void applySocketOptions(int sockfd, const SocketOptions &options) {
+    // esp_http_server leaves Nagle's algorithm enabled
+    setInt(sockfd, IPPROTO_TCP, TCP_NODELAY, options.noDelay, "TCP_NODELAY");
+
+    if (options.sendBufferSize != 0)
+        setInt(sockfd, SOL_SOCKET, SO_SNDBUF, static_cast<int>(options.sendBufferSize), "SO_SNDBUF");
+
+    if (options.receiveBufferSize != 0)
+        setInt(sockfd, SOL_SOCKET, SO_RCVBUF, static_cast<int>(options.receiveBufferSize), "SO_RCVBUF");
+
+    if (options.keepAliveIdle.count() != 0) {
+        setInt(sockfd, SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE");
+        setInt(sockfd, IPPROTO_TCP, TCP_KEEPIDLE, static_cast<int>(options.keepAliveIdle.count()), "TCP_KEEPIDLE");
+
+        if (options.keepAliveInterval.count() != 0) {
+            auto interval = static_cast<int>(options.keepAliveInterval.count());
+            setInt(sockfd, IPPROTO_TCP, TCP_KEEPINTVL, interval, "TCP_KEEPINTVL");
+        }
+
+        if (options.keepAliveCount != 0) {
+            setInt(sockfd, IPPROTO_TCP, TCP_KEEPCNT, static_cast<int>(options.keepAliveCount), "TCP_KEEPCNT");
+        }
+    }
+
+    // esp_http_server sets them from the config before the socket is passed to open_fn
+    if (options.sendTimeout.count() != 0)
+        setTimeout(sockfd, SO_SNDTIMEO, options.sendTimeout, "SO_SNDTIMEO");
+
+    if (options.receiveTimeout.count() != 0)
+        setTimeout(sockfd, SO_RCVTIMEO, options.receiveTimeout, "SO_RCVTIMEO");
+}
+}
@@ -0,0 +1,16 @@
+#ifndef EXPRESSIF_SOCKETTUNING_H
+#define EXPRESSIF_SOCKETTUNING_H
+
+#include "../../include/expressif/http/server/SocketOptions.h"
+
+namespace expressif::http::server::detail {
+/**
+ * Applies the options to the accepted socket, see HTTPServer::setSocketOptions.
+ * The options not supported by the network stack are skipped.
+ * @param sockfd The socket
+ * @param options The options
+ */
+void applySocketOptions(int sockfd, const SocketOptions &options);
+}
+
+#endif //EXPRESSIF_SOCKETTUNING_H
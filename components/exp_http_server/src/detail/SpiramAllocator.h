@@ -0,0 +1,46 @@
+#ifndef EXPRESSIF_SPIRAMALLOCATOR_H
+#define EXPRESSIF_SPIRAMALLOCATOR_H
+
+#include <esp_heap_caps.h>
+
+#include <cstddef>
+#include <cstdlib>
+
+namespace expressif::http::server::detail {
+/**
+ * Allocates memory in PSRAM if available, in the internal RAM otherwise.
+ */
+template<typename T>
+struct SpiramAllocator {
+    using value_type = T;
+
+    SpiramAllocator() = default;
+
+    template<typename U>
+    constexpr SpiramAllocator(const SpiramAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        auto ptr = heap_caps_malloc_prefer(
+            n * sizeof(T), 2,
+            MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+            MALLOC_CAP_DEFAULT);
+
+        // the same as the failed operator new without exceptions
+        if (ptr == nullptr)
+            abort();
+
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T *ptr, size_t) noexcept {
+        heap_caps_free(ptr);
+    }
+
+    template<typename U>
+    bool operator==(const SpiramAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+}
+
+#endif //EXPRESSIF_SPIRAMALLOCATOR_H
@@ -0,0 +1,22 @@
+#ifndef EXPRESSIF_STRINGUTILS_H
+#define EXPRESSIF_STRINGUTILS_H
+
+#include <string_view>
+#include <strings.h>
+
+namespace expressif::http::server::detail {
+inline std::string_view trim(std::string_view str) {
+    auto begin = str.find_first_not_of(" \t");
+
+    if (begin == std::string_view::npos)
+        return {};
+
+    return str.substr(begin, str.find_last_not_of(" \t") - begin + 1);
+}
+
+inline bool equalsIgnoreCase(std::string_view s1, std::string_view s2) {
+    return s1.size() == s2.size() && strncasecmp(s1.data(), s2.data(), s1.size()) == 0;
+}
+}
+
+#endif //EXPRESSIF_STRINGUTILS_H
@@ -0,0 +1,185 @@
+#include "Tracer.h"
+
+#if CONFIG_HTTP_SERVER_TRACING
+#include "RequestContext.h"
+
+#include "../../include/expressif/http/server/JsonWriter.h"
+
+#include <esp_timer.h>
+
+#include <array>
+#include <atomic>
+#include <utility>
+
+namespace expressif::http::server::detail {
+constexpr static auto relaxed = std::memory_order_relaxed;
+
+/**
+ * The sequence number tells whether the slot holds the expected event:
+ * it is reset while the slot is being written, so a reader racing with
+ * the writer discards the slot instead of reading a torn event.
+ * @note The fields are 32-bit, since wider atomics are not lock-free
+ * on the supported targets.
+ */
+struct TraceSlot {
+    std::atomic<uint32_t> sequence {0}; // the index of the event + 1, 0 if not written
+    std::atomic<uint32_t> start {0}; // the lower 32 bits of esp_timer_get_time
+    std::atomic<uint32_t> duration {0};
+    std::atomic<uint32_t> requestId {0};
+    std::atomic<uint32_t> tag {0}; // phase << 24 | socket
+    std::atomic<uint32_t> value {0};
+};
+
+constexpr static uint32_t BufferSize = CONFIG_HTTP_SERVER_TRACE_BUFFER_SIZE;
+
+// preallocated, the oldest events are overwritten
+static std::array<TraceSlot, BufferSize> slots;
+static std::atomic<uint32_t> head {0};
+static std::atomic<uint32_t> lastRequestId {0};
+
+static uint32_t now() {
+    return static_cast<uint32_t>(esp_timer_get_time());
+}
+
+static void record(uint32_t requestId, int socket, TracePhase phase, uint32_t start, uint32_t value) {
+    auto duration = now() - start;
+    auto index = head.fetch_add(1, relaxed);
+    auto &slot = slots[index % BufferSize];
+
+    slot.sequence.store(0, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.start.store(start, relaxed);
+    slot.duration.store(duration, relaxed);
+    slot.requestId.store(requestId, relaxed);
+    slot.tag.store(static_cast<uint32_t>(phase) << 24 | (static_cast<uint32_t>(socket) & 0xffffff), relaxed);
+    slot.value.store(value, relaxed);
+
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+TraceSpan::TraceSpan(int socket)
+    : m_socket(socket),
+      m_start(now())
+{
+    // 0 is reserved for inactive spans
+    do {
+        m_requestId = lastRequestId.fetch_add(1, relaxed) + 1;
+    } while (m_requestId == 0);
+}
+
+TraceSpan::TraceSpan(const TraceSpan &parent, TracePhase phase)
+    : m_requestId(parent.m_requestId),
+      m_socket(parent.m_socket),
+      m_phase(phase),
+      m_start(now()) {}
+
+// the context is not available e.g. in the error handlers
+static const TraceSpan& getRequestSpan(httpd_req_t *req) {
+    static const TraceSpan inactive;
+    auto context = RequestContext::of(req);
+    return context != nullptr ? context->span : inactive;
+}
+
+TraceSpan::TraceSpan(httpd_req_t *req, TracePhase phase)
+    : TraceSpan(getRequestSpan(req), phase) {}
+
+TraceSpan::TraceSpan(TraceSpan &&other) noexcept
+    : m_requestId(std::exchange(other.m_requestId, 0)),
+      m_socket(other.m_socket),
+      m_phase(other.m_phase),
+      m_start(other.m_start),
+      m_value(other.m_value) {}
+
+TraceSpan& TraceSpan::operator=(TraceSpan &&other) noexcept {
+    if (this != &other) {
+        end();
+        m_requestId = std::exchange(other.m_requestId, 0);
+        m_socket = other.m_socket;
+        m_phase = other.m_phase;
+        m_start = other.m_start;
+        m_value = other.m_value;
+    }
+
+    return *this;
+}
+
+TraceSpan::~TraceSpan() {
+    end();
+}
+
+void TraceSpan::setValue(uint32_t value) {
+    m_value = value;
+}
+
+void TraceSpan::end() {
+    if (m_requestId != 0) {
+        record(std::exchange(m_requestId, 0), m_socket, m_phase, m_start, m_value);
+    }
+}
+
+static const char* getName(TracePhase phase) {
+    switch (phase) {
+        case TracePhase::Request: return "Request";
+        case TracePhase::Routing: return "Routing";
+        case TracePhase::Handler: return "Handler";
+        case TracePhase::Receive: return "Receive";
+        case TracePhase::Send: return "Send";
+        default: return "Unknown";
+    }
+}
+
+esp_err_t writeTrace(Response response) {
+    // the events recorded while writing are not included
+    auto end = head.load(std::memory_order_acquire);
+    auto begin = end > BufferSize ? end - BufferSize : 0;
+
+    // the timestamps are restored relative to the current time
+    auto time = esp_timer_get_time();
+
+    JsonWriter json(response);
+    json.beginObject().key("traceEvents").beginArray();
+
+    for (auto index = begin; index != end; ++index) {
+        auto &slot = slots[index % BufferSize];
+
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+            continue;
+
+        auto start = slot.start.load(relaxed);
+        auto duration = slot.duration.load(relaxed);
+        auto requestId = slot.requestId.load(relaxed);
+        auto tag = slot.tag.load(relaxed);
+        auto value = slot.value.load(relaxed);
+
+        // overwritten meanwhile
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (slot.sequence.load(relaxed) != index + 1)
+            continue;
+
+        auto phase = static_cast<TracePhase>(tag >> 24);
+
+        json.beginObject()
+            .field("name", getName(phase))
+            .field("cat", "http")
+            .field("ph", "X")
+            .field("ts", time - static_cast<uint32_t>(static_cast<uint32_t>(time) - start))
+            .field("dur", duration)
+            .field("pid", 0)
+            .field("tid", tag & 0xffffff)
+            .key("args").beginObject()
+            .field("request", requestId);
+
+        if (phase == TracePhase::Receive || phase == TracePhase::Send)
+            json.field("bytes", value);
+
+        json.endObject().endObject();
+    }
+
+    json.endArray().field("displayTimeUnit", "ms").endObject();
+
+    return json.finish();
+}
+}
+#endif //CONFIG_HTTP_SERVER_TRACING
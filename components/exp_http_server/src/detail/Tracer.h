@@ -0,0 +1,89 @@
+#ifndef EXPRESSIF_TRACER_H
+#define EXPRESSIF_TRACER_H
+
+#include <esp_http_server.h>
+
+#include <cstdint>
+
+#include "../../include/expressif/http/server/Response.h"
+
+#include "sdkconfig.h"
+
+namespace expressif::http::server::detail {
+enum class TracePhase : uint8_t {
+    Request, ///< from receiving the request until it ends
+    Routing,
+    Handler, ///< the call of the handler in the server or worker task
+    Receive, ///< a single read of the body
+    Send
+};
+
+#if CONFIG_HTTP_SERVER_TRACING
+/**
+ * The phase of the request, recorded into the trace buffer when the span ends.
+ * Spans of the same request share its id.
+ */
+class TraceSpan {
+public:
+    TraceSpan() = default;
+
+    /**
+     * Starts the span of the new request.
+     * @param socket The socket of the request, the spans of the same
+     * connection are displayed on the same track
+     */
+    explicit TraceSpan(int socket);
+
+    /**
+     * Starts the nested span, inactive if the parent is inactive.
+     */
+    TraceSpan(const TraceSpan &parent, TracePhase phase);
+
+    /**
+     * Starts the nested span of the request, see RequestContext::span.
+     */
+    TraceSpan(httpd_req_t *req, TracePhase phase);
+
+    TraceSpan(TraceSpan &&other) noexcept;
+    TraceSpan& operator=(TraceSpan &&other) noexcept;
+
+    ~TraceSpan();
+
+    /**
+     * @param value The number of bytes received or sent
+     */
+    void setValue(uint32_t value);
+
+    /**
+     * Records the span, called by the destructor.
+     */
+    void end();
+
+private:
+    uint32_t m_requestId {0}; // 0 if inactive
+    int m_socket {-1};
+    TracePhase m_phase {TracePhase::Request};
+    uint32_t m_start {0};
+    uint32_t m_value {0};
+};
+
+/**
+ * Writes the recorded spans in the Chrome trace event format.
+ * @see HTTPServer::writeTrace
+ */
+esp_err_t writeTrace(Response response);
+#else
+// the hooks are compiled out
+class TraceSpan {
+public:
+    TraceSpan() = default;
+    TraceSpan(const TraceSpan&, TracePhase) {}
+    TraceSpan(httpd_req_t*, TracePhase) {}
+
+    void setValue(uint32_t) {}
+    void end() {}
+};
+#endif
+}
+
+#endif //EXPRESSIF_TRACER_H
@@ -0,0 +1,93 @@
+#include "WorkerPool.h"
+
+#include <freertos/task.h>
+#include <esp_log.h>
+
+#include <memory>
+
+namespace expressif::http::server::detail {
+constexpr static auto TAG = "expressif::http::server::WorkerPool";
+
+WorkerPool::WorkerPool(const WorkerPoolConfig &config, Handler handler)
+    : m_handler(std::move(handler)),
+      m_queue(xQueueCreate(config.queueSize, sizeof(Job*))),
+      m_stopped(xSemaphoreCreateCounting(config.workerCount, 0))
+{
+    if (m_queue == nullptr || m_stopped == nullptr)
+        return;
+
+    for (size_t i = 0; i < config.workerCount; ++i) {
+        auto coreId = config.coreIds.empty() ? tskNO_AFFINITY : config.coreIds[i % config.coreIds.size()];
+
+        auto ret = xTaskCreatePinnedToCore(
+            run, "http_worker", config.stackSize, this, config.priority, nullptr, coreId);
+
+        if (ret != pdPASS) {
+            ESP_LOGE(TAG, "Cannot create worker #%zu", i);
+            break;
+        }
+
+        ++m_workerCount;
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    // the queue is FIFO: the pending jobs are done first
+    for (size_t i = 0; i < m_workerCount; ++i) {
+        Job *stop = nullptr;
+        xQueueSend(m_queue, &stop, portMAX_DELAY);
+    }
+
+    for (size_t i = 0; i < m_workerCount; ++i)
+        xSemaphoreTake(m_stopped, portMAX_DELAY);
+
+    if (m_queue != nullptr)
+        vQueueDelete(m_queue);
+
+    if (m_stopped != nullptr) {
+        vSemaphoreDelete(m_stopped);
+    }
+}
+
+bool WorkerPool::isValid() const {
+    return m_workerCount > 0;
+}
+
+bool WorkerPool::hasCapacity() const {
+    return isValid() && uxQueueSpacesAvailable(m_queue) > 0;
+}
+
+size_t WorkerPool::getQueuedCount() const {
+    return isValid() ? uxQueueMessagesWaiting(m_queue) : 0;
+}
+
+bool WorkerPool::submit(Job &&job) {
+    if (!isValid())
+        return false;
+
+    auto queued = new Job(std::move(job));
+
+    if (xQueueSend(m_queue, &queued, 0) != pdTRUE) {
+        job = std::move(*queued);
+        delete queued;
+        return false;
+    }
+
+    return true;
+}
+
+void WorkerPool::run(void *arg) {
+    auto self = static_cast<WorkerPool*>(arg);
+
+    Job *job;
+
+    while (xQueueReceive(self->m_queue, &job, portMAX_DELAY) == pdTRUE && job != nullptr) {
+        // completes the request when it goes out of scope
+        std::unique_ptr<Job> owned(job);
+        self->m_handler(*owned);
+    }
+
+    xSemaphoreGive(self->m_stopped);
+    vTaskDelete(nullptr);
+}
+}
@@ -0,0 +1,87 @@
+#ifndef EXPRESSIF_WORKERPOOL_H
+#define EXPRESSIF_WORKERPOOL_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include <expressif/InplaceFunction.h>
+
+#include <memory>
+#include <string>
+
+#include "../../include/expressif/http/server/AsyncRequest.h"
+#include "../../include/expressif/http/server/WorkerPoolConfig.h"
+
+namespace expressif::http::server::detail {
+class EndpointData;
+
+/**
+ * The request offloaded to the worker pool.
+ */
+struct Job {
+    AsyncRequest request;
+
+    // the endpoint may be removed while the job is queued
+    std::shared_ptr<EndpointData> endpoint;
+
+    // empty if the response must not be cached
+    std::string cacheKey;
+
+    // when the job has been submitted (in microseconds), see detail::LoadMonitor
+    int64_t submitTime {0};
+};
+
+/**
+ * Runs the jobs in a pool of FreeRTOS tasks fed by a bounded queue.
+ */
+class WorkerPool {
+public:
+    using Handler = InplaceFunction<void(Job&)>;
+
+public:
+    WorkerPool(const WorkerPoolConfig &config, Handler handler);
+
+    /**
+     * Waits for the queued jobs and stops the workers.
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @return `false` if the pool has not been started, e.g. due to lack of memory
+     */
+    bool isValid() const;
+
+    /**
+     * @return `true` if the job can be submitted without waiting
+     * @note Only the server task submits the jobs, so the result stays valid
+     * until the next submit.
+     */
+    bool hasCapacity() const;
+
+    /**
+     * @return The number of jobs waiting for a worker
+     */
+    size_t getQueuedCount() const;
+
+    /**
+     * Queues the job, does not wait.
+     * @return `false` if the queue is full
+     */
+    bool submit(Job &&job);
+
+private:
+    static void run(void *arg);
+
+private:
+    Handler m_handler;
+    QueueHandle_t m_queue;
+    SemaphoreHandle_t m_stopped;
+    size_t m_workerCount {0};
+};
+}
+
+#endif //EXPRESSIF_WORKERPOOL_H
@@ -0,0 +1,47 @@
+#include <expressif/http/server/util/AcceptEncoding.h>
+
+#include "../detail/StringUtils.h"
+
+namespace expressif::http::server {
+using detail::trim;
+using detail::equalsIgnoreCase;
+
+// q=0, q=0.0, q=0.00 or q=0.000
+inline static bool isZeroWeight(std::string_view params) {
+    auto pos = params.find("q=");
+
+    if (pos == std::string_view::npos)
+        return false;
+
+    auto value = trim(params.substr(pos + 2));
+
+    return !value.empty() && value.front() == '0' &&
+           value.find_first_not_of("0.", 1) == std::string_view::npos;
+}
+
+bool AcceptEncoding::isAccepted(std::string_view header, std::string_view coding) {
+    bool wildcard = false;
+
+    while (!header.empty()) {
+        auto end = header.find(',');
+        auto item = header.substr(0, end);
+        auto paramsPos = item.find(';');
+
+        auto name = trim(item.substr(0, paramsPos));
+        auto accepted = paramsPos == std::string_view::npos || !isZeroWeight(item.substr(paramsPos + 1));
+
+        if (equalsIgnoreCase(name, coding))
+            return accepted;
+
+        if (name == "*")
+            wildcard = accepted;
+
+        if (end == std::string_view::npos)
+            break;
+
+        header.remove_prefix(end + 1);
+    }
+
+    return wildcard;
+}
+}
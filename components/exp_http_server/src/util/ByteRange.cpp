@@ -0,0 +1,80 @@
+#include <expressif/http/server/util/ByteRange.h>
+
+#include <algorithm>
+#include <charconv>
+
+#include "../detail/StringUtils.h"
+
+namespace expressif::http::server {
+using detail::trim;
+using detail::equalsIgnoreCase;
+
+inline static bool parseSize(std::string_view str, size_t &result) {
+    auto [ptr, ec] = std::from_chars(str.begin(), str.end(), result);
+    return !str.empty() && ec == std::errc() && ptr == str.end();
+}
+
+std::optional<std::vector<ByteRange>> ByteRange::parse(std::string_view header, size_t size) {
+    constexpr std::string_view unit = "bytes=";
+
+    header = trim(header);
+
+    if (header.size() <= unit.size() || !equalsIgnoreCase(header.substr(0, unit.size()), unit))
+        return {};
+
+    header.remove_prefix(unit.size());
+
+    std::vector<ByteRange> ranges;
+    size_t count = 0;
+
+    while (!header.empty()) {
+        auto end = header.find(',');
+        auto spec = trim(header.substr(0, end));
+        auto dash = spec.find('-');
+
+        if (dash == std::string_view::npos || ++count > MaxCount)
+            return {};
+
+        auto firstStr = spec.substr(0, dash);
+        auto lastStr = spec.substr(dash + 1);
+
+        if (firstStr.empty()) {
+            // suffix range: the last N bytes
+            size_t suffix;
+
+            if (!parseSize(lastStr, suffix))
+                return {};
+
+            if (suffix > 0 && size > 0) {
+                auto length = std::min(suffix, size);
+                ranges.push_back({size - length, length});
+            }
+        } else {
+            size_t first;
+            size_t last = size > 0 ? size - 1 : 0;
+
+            if (!parseSize(firstStr, first))
+                return {};
+
+            if (!lastStr.empty()) {
+                if (!parseSize(lastStr, last) || last < first) {
+                    return {};
+                }
+
+                last = std::min(last, size > 0 ? size - 1 : 0);
+            }
+
+            if (first < size) {
+                ranges.push_back({first, last - first + 1});
+            }
+        }
+
+        if (end == std::string_view::npos)
+            break;
+
+        header.remove_prefix(end + 1);
+    }
+
+    return ranges;
+}
+}
@@ -0,0 +1,42 @@
+#include <expressif/http/server/util/ETag.h>
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "../detail/StringUtils.h"
+
+namespace expressif::http::server {
+using detail::trim;
+
+std::string ETag::make(uint64_t hash, bool weak) {
+    char buff[24];
+    auto n = snprintf(buff, sizeof(buff), "%s\"%016" PRIx64 "\"", weak ? "W/" : "", hash);
+    return {buff, static_cast<size_t>(n)};
+}
+
+inline static std::string_view opaqueTag(std::string_view etag) {
+    return etag.starts_with("W/") ? etag.substr(2) : etag;
+}
+
+bool ETag::matches(std::string_view header, std::string_view etag) {
+    if (etag.empty())
+        return false;
+
+    auto tag = opaqueTag(etag);
+
+    while (!header.empty()) {
+        auto end = header.find(',');
+        auto item = trim(header.substr(0, end));
+
+        if (item == "*" || opaqueTag(item) == tag)
+            return true;
+
+        if (end == std::string_view::npos)
+            break;
+
+        header.remove_prefix(end + 1);
+    }
+
+    return false;
+}
+}
@@ -0,0 +1,75 @@
+#include <expressif/http/server/util/HTTPDate.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdio>
+
+namespace expressif::http::server {
+constexpr static std::array<std::string_view, 7> weekDays {
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+};
+
+constexpr static std::array<std::string_view, 12> months {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+std::string HTTPDate::format(time_t time) {
+    tm t {};
+    gmtime_r(&time, &t);
+
+    char buff[32];
+
+    auto n = snprintf(buff, sizeof(buff), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+                      weekDays[t.tm_wday].data(), t.tm_mday, months[t.tm_mon].data(),
+                      t.tm_year + 1900, t.tm_hour, t.tm_min, t.tm_sec);
+
+    return {buff, static_cast<size_t>(n)};
+}
+
+/**
+ * Converts the civil date to the number of days since 1970-01-01.
+ * @see https://howardhinnant.github.io/date_algorithms.html#days_from_civil
+ */
+constexpr static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const auto yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+inline static bool parseInt(std::string_view str, int &result) {
+    auto [ptr, ec] = std::from_chars(str.begin(), str.end(), result);
+    return ec == std::errc() && ptr == str.end();
+}
+
+std::optional<time_t> HTTPDate::parse(std::string_view date) {
+    // Sun, 06 Nov 1994 08:49:37 GMT
+    // 0123456789012345678901234567
+    if (date.size() != 29 || date.substr(3, 2) != ", " || date.substr(25) != " GMT" ||
+        date[7] != ' ' || date[11] != ' ' || date[16] != ' ' || date[19] != ':' || date[22] != ':')
+    {
+        return {};
+    }
+
+    int day, year, hour, min, sec;
+
+    if (!parseInt(date.substr(5, 2), day) || !parseInt(date.substr(12, 4), year) ||
+        !parseInt(date.substr(17, 2), hour) || !parseInt(date.substr(20, 2), min) ||
+        !parseInt(date.substr(23, 2), sec))
+    {
+        return {};
+    }
+
+    auto month = std::find(months.begin(), months.end(), date.substr(8, 3));
+
+    if (month == months.end())
+        return {};
+
+    auto days = daysFromCivil(year, month - months.begin() + 1, day);
+
+    return static_cast<time_t>(days * 86400 + hour * 3600 + min * 60 + sec);
+}
+}
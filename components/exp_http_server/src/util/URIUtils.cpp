@@ -54,6 +54,9 @@
 #define NGX_UNESCAPE_REDIRECT     (2)
 
 namespace expressif::http::server {
+static_assert(static_cast<unsigned int>(URIUtils::EscapeMode::HTML) == NGX_ESCAPE_HTML);
+static_assert(static_cast<unsigned int>(URIUtils::EscapeMode::MailAuth) == NGX_ESCAPE_MAIL_AUTH);
+
 static uintptr_t ngx_escape_uri(u_char *dst, u_char *src, size_t size, unsigned int type) {
     unsigned int      n;
     uint32_t       *escape;
@@ -383,7 +386,17 @@ std::string URIUtils::decode(std::string_view src) {
     return result;
 }
 
-uint32_t URIUtils::encode(char *dest, std::string_view src) {
+std::pmr::string URIUtils::decode(std::string_view src, std::pmr::memory_resource *resource) {
+    std::pmr::string result(src.size(), '\0', resource);
+    decode(result.data(), src);
+
+    if (auto index = result.find('\0'); index != std::pmr::string::npos)
+        result.erase(index);
+
+    return result;
+}
+
+uint32_t URIUtils::encode(char *dest, std::string_view src, EscapeMode mode) {
     if (src.empty() || !dest) {
         return 0;
     }
@@ -392,11 +405,15 @@ uint32_t URIUtils::encode(char *dest, std::string_view src) {
             (unsigned char*) dest,
             (unsigned char*) src.data(),
             src.size(),
-            NGX_ESCAPE_URI_COMPONENT);
+            static_cast<unsigned int>(mode));
 
     return (uint32_t)(ret - (uintptr_t)dest);
 }
 
+uint32_t URIUtils::encode(char *dest, std::string_view src) {
+    return encode(dest, src, EscapeMode::URIComponent);
+}
+
 std::string URIUtils::encode(std::string_view src) {
     std::string result(src.size() * 3, '\0');
     auto count = encode(result.data(), src);
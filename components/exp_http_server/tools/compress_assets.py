@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""
+Copies web assets to the output directory and generates precompressed
+sidecars next to them (e.g. index.js -> index.js.gz, index.js.br), which
+are served by StaticFileHandler when the client accepts the encoding.
+
+Brotli sidecars are generated only if the `brotli` module is installed.
+A sidecar is kept only if it is noticeably smaller than the original file.
+
+Usage:
+    compress_assets.py <source dir> <output dir> [--min-ratio 0.9]
+"""
+
+import argparse
+import gzip
+import os
+import shutil
+
+try:
+    import brotli
+except ImportError:
+    brotli = None
+
+# already compressed formats, compressing them again is pointless
+SKIP_EXTENSIONS = {".png", ".jpg", ".jpeg", ".gif", ".webp", ".ico", ".woff", ".woff2", ".gz", ".br", ".zip"}
+
+
+def _compressors():
+    """(content coding, sidecar extension, compressor) in order of preference"""
+    result = []
+
+    if brotli is not None:
+        result.append(("br", ".br", lambda data: brotli.compress(data, quality=11)))
+
+    result.append(("gzip", ".gz", lambda data: gzip.compress(data, compresslevel=9, mtime=0)))
+
+    return result
+
+
+def compress_variants(name: str, data: bytes, min_ratio: float = 0.9):
+    """
+    Compresses the content of the file with each of the supported encodings.
+    Also used by embed_assets.py, so both kinds of assets get the same variants.
+
+    :return: [(content coding, sidecar extension, compressed content)] in order of preference,
+             only the variants whose size <= original size * min_ratio
+    """
+    if os.path.splitext(name)[1].lower() in SKIP_EXTENSIONS:
+        return []
+
+    result = []
+
+    for encoding, ext, compress in _compressors():
+        compressed = compress(data)
+
+        if len(compressed) <= len(data) * min_ratio:
+            result.append((encoding, ext, compressed))
+
+    return result
+
+
+def compress_dir(src: str, dst: str, min_ratio: float = 0.9, verbose: bool = True):
+    if os.path.exists(dst):
+        shutil.rmtree(dst)
+
+    shutil.copytree(src, dst)
+
+    if verbose and brotli is None:
+        print("compress_assets: brotli module not found, skipping .br sidecars")
+
+    for root, _, files in os.walk(dst):
+        for name in files:
+            path = os.path.join(root, name)
+
+            with open(path, "rb") as f:
+                data = f.read()
+
+            for _, ext, compressed in compress_variants(name, data, min_ratio):
+                with open(path + ext, "wb") as f:
+                    f.write(compressed)
+
+                if verbose:
+                    print(f"compress_assets: {os.path.relpath(path, dst)}{ext}: {len(data)} -> {len(compressed)} bytes")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generates precompressed sidecars for web assets")
+    parser.add_argument("src", help="the source directory")
+    parser.add_argument("dst", help="the output directory, will be overwritten")
+    parser.add_argument("--min-ratio", type=float, default=0.9,
+                        help="keep a sidecar only if compressed size <= original size * ratio")
+    args = parser.parse_args()
+
+    compress_dir(args.src, args.dst, args.min_ratio)
+
+
+if __name__ == "__main__":
+    main()
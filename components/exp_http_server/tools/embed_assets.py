@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Generates a C++ header with a constexpr table of assets (expressif::http::server::EmbeddedAsset)
+from the specified directory. The table is served by EmbeddedAssetHandler directly from flash.
+
+For each file, precompressed variants (br, if the `brotli` module is installed, and gzip)
+are embedded as well if they are noticeably smaller than the original.
+
+Usage:
+    embed_assets.py <source dir> <output header> [--namespace web] [--name assets]
+"""
+
+import argparse
+import os
+
+from compress_assets import compress_variants
+
+
+def fnv1a32(data: bytes) -> int:
+    h = 0x811c9dc5
+    for b in data:
+        h = ((h ^ b) * 0x01000193) & 0xffffffff
+    return h
+
+
+def fnv1a64(data: bytes) -> int:
+    h = 0xcbf29ce484222325
+    for b in data:
+        h = ((h ^ b) * 0x100000001b3) & 0xffffffffffffffff
+    return h
+
+
+def c_string(value: str) -> str:
+    """Quotes the value as a C string literal"""
+    result = []
+
+    for b in value.encode():
+        if b in (ord('"'), ord("\\")):
+            result.append("\\" + chr(b))
+        elif 0x20 <= b < 0x7f:
+            result.append(chr(b))
+        else:
+            # octal escapes are at most 3 digits long, unlike the hexadecimal ones
+            result.append(f"\\{b:03o}")
+
+    return '"' + "".join(result) + '"'
+
+
+def to_array(data: bytes) -> str:
+    # byte_t is signed
+    values = [str(b - 256 if b > 127 else b) for b in data]
+    lines = [", ".join(values[i:i + 20]) for i in range(0, len(values), 20)]
+    return ",\n    ".join(lines)
+
+
+def generate(src: str, namespace: str, name: str, min_ratio: float) -> str:
+    assets = []
+
+    for root, _, files in os.walk(src):
+        for file in sorted(files):
+            full_path = os.path.join(root, file)
+            path = os.path.relpath(full_path, src).replace(os.sep, "/")
+
+            with open(full_path, "rb") as f:
+                data = f.read()
+
+            # in order of preference, the original is the last
+            variants = [(encoding, content) for encoding, _, content in compress_variants(file, data, min_ratio)]
+            variants.append(("", data))
+
+            for encoding, content in variants:
+                assets.append({
+                    "hash": fnv1a32(path.encode()),
+                    "path": path,
+                    "etag": f'"{fnv1a64(content):016x}"',
+                    "encoding": encoding,
+                    "data": content,
+                })
+
+    # the variants of a path stay in order: the sort is stable
+    assets.sort(key=lambda a: (a["hash"], a["path"]))
+
+    out = [
+        "// Generated by embed_assets.py, do not edit",
+        "#pragma once",
+        "",
+        "#include <expressif/http/server/EmbeddedAssets.h>",
+        "#include <expressif/http/server/util/MimeTypes.h>",
+        "",
+        f"namespace {namespace} {{",
+        "namespace detail {",
+    ]
+
+    for i, asset in enumerate(assets):
+        encoding = f" ({asset['encoding']})" if asset["encoding"] else ""
+        out += [
+            f"// {c_string(asset['path'])}{encoding}",
+            f"inline constexpr expressif::http::server::byte_t {name}_data{i}[] = {{",
+            f"    {to_array(asset['data'])}",
+            "};",
+            "",
+        ]
+
+    out += [
+        "}",
+        "",
+        f"inline constexpr expressif::http::server::EmbeddedAsset {name}[] = {{",
+    ]
+
+    for i, asset in enumerate(assets):
+        path = c_string(asset["path"])
+        out.append(
+            f'    {{0x{asset["hash"]:08x}u, {path}, detail::{name}_data{i}, '
+            f'expressif::http::server::MimeTypes::fromPath({path}), '
+            f'{c_string(asset["etag"])}, {c_string(asset["encoding"])}}},')
+
+    out += [
+        "};",
+        "",
+        f"static_assert(expressif::http::server::EmbeddedAsset::isSorted({name}));",
+        "}",
+        "",
+    ]
+
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generates a constexpr table of embedded web assets")
+    parser.add_argument("src", help="the assets directory")
+    parser.add_argument("out", help="the header to be generated")
+    parser.add_argument("--namespace", default="assets", help="the namespace of the table")
+    parser.add_argument("--name", default="assets", help="the name of the table")
+    parser.add_argument("--min-ratio", type=float, default=0.9,
+                        help="embed a compressed variant only if its size <= original size * ratio")
+    args = parser.parse_args()
+
+    content = generate(args.src, args.namespace, args.name, args.min_ratio)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.out)), exist_ok=True)
+
+    # do not touch the header if nothing has changed to avoid rebuilds
+    if os.path.exists(args.out):
+        with open(args.out) as f:
+            if f.read() == content:
+                return
+
+    with open(args.out, "w") as f:
+        f.write(content)
+
+
+if __name__ == "__main__":
+    main()
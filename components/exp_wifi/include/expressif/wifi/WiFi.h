@@ -1,7 +1,6 @@
 #ifndef EXPRESSIF_WIFI_H
 #define EXPRESSIF_WIFI_H
 
-#include <functional>
 #include <vector>
 #include <string_view>
 
@@ -12,11 +11,13 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 
+#include <expressif/InplaceFunction.h>
+
 namespace expressif::wifi {
 class WiFi {
 public:
     template<typename... Args>
-    using Handler = std::function<void(Args...)>;
+    using Handler = InplaceFunction<void(Args...)>;
 
     using NetinfConfig = esp_netif_inherent_config_t;
     using Config = wifi_config_t;
@@ -39,8 +40,8 @@ public:
 
     void shutdown();
 
-    void addOnConnectedHandler(const Handler<> &handler);
-    void addOnDisconnectedHandler(const Handler<> &handler);
+    void addOnConnectedHandler(Handler<> handler);
+    void addOnDisconnectedHandler(Handler<> handler);
 
     static WiFi* getInstance();
 
@@ -61,7 +62,7 @@ private:
 public: // IPv4
     using IPv4Info = esp_netif_ip_info_t;
 
-    void addOnIPv4ObtainedHandler(const Handler<const IPv4Info&> &handler);
+    void addOnIPv4ObtainedHandler(Handler<const IPv4Info&> handler);
 
     static void onIPv4Obtained(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
 
@@ -73,7 +74,7 @@ private:
 public: // IPv6
     using IPv6Info = esp_netif_ip6_info_t;
 
-    void addOnIPv6ObtainedHandler(const Handler<const IPv6Info&> &handler);
+    void addOnIPv6ObtainedHandler(Handler<const IPv6Info&> handler);
 
     static void onIPv6Obtained(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
 
@@ -4,6 +4,7 @@
 #include <esp_log.h>
 
 #include <cstring>
+#include <utility>
 
 #include "sdkconfig.h"
 
@@ -149,12 +150,12 @@ void WiFi::shutdown() {
     stop();
 }
 
-void WiFi::addOnConnectedHandler(const Handler<> &handler) {
-    m_onConnectedHandlers.emplace_back(handler);
+void WiFi::addOnConnectedHandler(Handler<> handler) {
+    m_onConnectedHandlers.emplace_back(std::move(handler));
 }
 
-void WiFi::addOnDisconnectedHandler(const Handler<> &handler) {
-    m_onDisconnectedHandlers.emplace_back(handler);
+void WiFi::addOnDisconnectedHandler(Handler<> handler) {
+    m_onDisconnectedHandlers.emplace_back(std::move(handler));
 }
 
 WiFi* WiFi::getInstance() {
@@ -162,12 +163,12 @@ WiFi* WiFi::getInstance() {
     return &wifi;
 }
 
-void WiFi::addOnIPv4ObtainedHandler(const Handler<const IPv4Info&> &handler) {
-    m_onIPv4Handlers.emplace_back(handler);
+void WiFi::addOnIPv4ObtainedHandler(Handler<const IPv4Info&> handler) {
+    m_onIPv4Handlers.emplace_back(std::move(handler));
 }
 
-void WiFi::addOnIPv6ObtainedHandler(const Handler<const IPv6Info&> &handler) {
-    m_onIPv6Handlers.emplace_back(handler);
+void WiFi::addOnIPv6ObtainedHandler(Handler<const IPv6Info&> handler) {
+    m_onIPv6Handlers.emplace_back(std::move(handler));
 }
 
 void WiFi::onConnected(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
@@ -0,0 +1,21 @@
+from SCons.Script import DefaultEnvironment, Return, COMMAND_LINE_TARGETS
+import os.path
+import sys
+
+env = DefaultEnvironment()
+
+FS_TARGETS = {"buildfs", "uploadfs", "uploadfsota"}
+
+if env.IsIntegrationDump() or not FS_TARGETS.intersection(COMMAND_LINE_TARGETS):
+    Return()
+
+sys.path.append(os.path.join(env.subst("$PROJECT_DIR"), "..", "..", "components", "exp_http_server", "tools"))
+
+from compress_assets import compress_dir
+
+# the filesystem image is built from the staging directory
+# containing both the original files and their .gz/.br sidecars
+staging_dir = os.path.join(env.subst("$BUILD_DIR"), "data")
+compress_dir(env.subst("$PROJECT_DATA_DIR"), staging_dir)
+
+env.Replace(PROJECT_DATA_DIR=staging_dir)
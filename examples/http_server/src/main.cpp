@@ -1,11 +1,17 @@
-#include <fstream>
-
 #include <esp_log.h>
+#include <esp_partition.h>
 #include <esp_spiffs.h>
+#include <esp_timer.h>
 #include <nvs_flash.h>
 
 #include <expressif/wifi/WiFi.h>
 #include <expressif/http/server/HTTPServer.h>
+#include <expressif/http/server/StaticFileHandler.h>
+#include <expressif/http/server/EmbeddedAssets.h>
+#include <expressif/http/server/Template.h>
+#include <expressif/http/server/JsonWriter.h>
+
+#include "web_assets.h"
 
 #ifndef EXAMPLE_WIFI_SSID
 #define EXAMPLE_WIFI_SSID ""
@@ -95,6 +101,13 @@ extern "C" [[noreturn]] void app_main() {
 
     HTTPServer server;
 
+    // under load, 503 is sent instead of calling the handlers, except the critical ones;
+    // configured before the server is started
+    server.setLoadShedding();
+
+    // the handlers with EndpointOptions::offload run in these tasks
+    ESP_ERROR_CHECK(server.startWorkerPool());
+
     auto wifi = WiFi::getInstance();
     wifi->start();
     wifi->connect(EXAMPLE_WIFI_SSID, EXAMPLE_WIFI_PASSWORD);
@@ -117,6 +130,23 @@ extern "C" [[noreturn]] void app_main() {
     ESP_ERROR_CHECK(server.start());
     LOG("Server started");
 
+    // the idle connections are closed, so they do not take the sockets of the new clients
+    server.setSessionConfig({.idleTimeout = std::chrono::seconds(30), .maxRequests = 100});
+
+    // runs before every endpoint
+    server.use([](Request &req, Next &next) {
+        auto start = esp_timer_get_time();
+        auto result = next();
+        LOG("Dispatched in %lli us", esp_timer_get_time() - start);
+        return result;
+    });
+
+    // composed with the handlers at compile time
+    constexpr MiddlewareStack cors([](Request &req, auto &&next) {
+        req.response().setHeader("Access-Control-Allow-Origin", "*");
+        return next();
+    });
+
     server.addEndpoint(HTTPMethod::Post, "/api/echo", [](Request &req) {
         LOG("POST /api/echo");
 
@@ -135,6 +165,30 @@ extern "C" [[noreturn]] void app_main() {
         resp.flush();
 
         LOG("Done, totalCount=%i, totalSize=%i", chunkNumber, totalSize);
+    }, {.offload = true});
+
+    // the same, but suspended while waiting for the client instead of blocking a task
+    server.addEndpoint(HTTPMethod::Post, "/api/echo-async", [](Request &req) -> Task<HandlerResult> {
+        auto resp = req.response();
+        std::array<byte_t, CONFIG_HTTP_SERVER_CHUNK_SIZE> buffer;
+        size_t remaining = req.getContentLength();
+
+        while (remaining > 0) {
+            int ret = co_await req.readChunkAsync({buffer.data(), std::min(remaining, buffer.size())});
+
+            if (ret == HTTPD_SOCK_ERR_TIMEOUT)
+                continue;
+
+            if (ret <= 0)
+                co_return HandlerResult::Discard;
+
+            if (co_await resp.writeChunkAsync({buffer.data(), static_cast<size_t>(ret)}) != ESP_OK)
+                co_return HandlerResult::Discard;
+
+            remaining -= ret;
+        }
+
+        co_return resp.flush() == ESP_OK ? HandlerResult::Keep : HandlerResult::Discard;
     });
 
     server.addEndpoint(HTTPMethod::Post, "/api/echo-txt", [](Request &req) {
@@ -144,11 +198,11 @@ extern "C" [[noreturn]] void app_main() {
         req.response().writeAll({bytes});
     });
 
-    server.addEndpoint(HTTPMethod::Get, "/api/hello/{username}", [](Request &req) {
+    server.addEndpoint(HTTPMethod::Get, "/api/hello/{username}", cors.wrap([](Request &req) {
         auto &username = req.getPathVar("username");
         LOG("GET /api/hello/{username}: username=%s", username.c_str());
         req.response().write("Hello, " + username);
-    });
+    }));
 
     server.addEndpoint(HTTPMethod::Get, "/api/hello/{name}/{surname}", [](Request &req) {
         auto &name = req.getPathVar("name");
@@ -157,47 +211,119 @@ extern "C" [[noreturn]] void app_main() {
         req.response().write("Hello, " + name + " " + surname);
     });
 
+    // the stack usage of the rendering is exposed at /metrics
+    server.addEndpoint(HTTPMethod::Get, "/hello/{name}", [](Request &req) {
+        using Page = Template<
+            "<!DOCTYPE html><html><body>"
+            "<h1>Hello, {{name}}!</h1>"
+            "<a href=\"/api/hello/{{name|uri}}\">plain text</a>"
+            "</body></html>">;
+
+        auto &name = req.getPathVar("name");
+        LOG("GET /hello/{name}: name=%s", name.c_str());
+
+        auto resp = req.response();
+        resp.setType("text/html");
+        Page::render(resp, {{"name", name}});
+    }, {.trackResources = true});
+
     server.addEndpoint(HTTPMethod::Get, "/api/path/{path}*", [](Request &req) {
         auto &path = req.getPathVar("path");
         LOG("GET /api/path/{path}*, path=%s", path.c_str());
         req.response().write("Path: " + path);
     });
 
-    server.addEndpoint(HTTPMethod::Get, "/{file}*", [](Request &req) {
-        auto path = req.getPathVar("file");
-
-        if (path.empty())
-            path = "index.html";
-
-        if (std::ifstream file("/spiffs/" + path); file.is_open()) {
-            std::string type;
-
-            if (auto ext = std::string_view {path}.substr(path.find_last_of('.') + 1); ext == "html") {
-                type = "text/html";
-            } else if (ext == "css") {
-                type = "text/css";
-            } else if (ext == "js") {
-                type = "text/javascript";
-            } else if (ext == "png") {
-                type = "image/png";
-            } else if (ext == "ico") {
-                type = "image/x-icon";
-            }
-
-            req.response().setType(type);
-
-            char buff[128];
-
-            req.response().writeChunks([&]() {
-                if (file) {
-                    auto n = file.readsome(buff, sizeof(buff));
-                    return ConstBuffer(reinterpret_cast<byte_t*>(buff), n);
-                } else {
-                    return ConstBuffer {};
-                }
-            });
+    // generated at most once per 2 seconds, no matter how often it is polled;
+    // each client may poll up to 5 times per second, 429 otherwise; served under load
+    server.addEndpoint(HTTPMethod::Get, "/api/status", [](Request &req) {
+        LOG("GET /api/status");
+        JsonWriter json(req.response());
+        json.beginObject().field("uptime", esp_timer_get_time() / 1000000).endObject();
+        json.finish();
+    }, {
+        .cache = CachePolicy {.ttl = std::chrono::seconds(2)},
+        .rateLimit = RateLimit {.requests = 5, .burst = 5},
+        .priority = LoadPriority::Critical
+    });
+
+    // the state of the connection, kept across its keep-alive requests
+    struct Visits {
+        uint32_t count {0};
+    };
+
+    server.addEndpoint(HTTPMethod::Get, "/api/session", [&server](Request &req) {
+        auto session = req.getSession();
+        auto &visits = session->getContext<Visits>();
+        ++visits.count;
+
+        auto stats = server.getSessionStats();
+
+        JsonWriter json(req.response());
+        json.beginObject()
+            .field("socket", session->getSocket())
+            .field("requests", session->getRequestCount())
+            .field("visits", visits.count)
+            .field("active", stats.active)
+            .field("purged", stats.lruPurged)
+            .endObject();
+        json.finish();
+    });
+
+    // applied to the new connections, e.g. to compare the presets with tools/http_bench;
+    // runs in the server task, which accepts the connections
+    server.addEndpoint(HTTPMethod::Put, "/api/socket/{preset}", [&server](Request &req) {
+        auto &preset = req.getPathVar("preset");
+        LOG("PUT /api/socket/{preset}: preset=%s", preset.c_str());
+
+        if (preset == "latency") {
+            server.setSocketOptions(SocketOptions::forLatency());
+        } else if (preset == "throughput") {
+            server.setSocketOptions(SocketOptions::forThroughput());
         } else {
             req.response().error404();
+            return;
+        }
+
+        req.response().write("Applied to the new connections");
+    });
+
+    // Prometheus text format
+    server.addMetricsEndpoint("/metrics");
+
+#if CONFIG_HTTP_SERVER_TRACING
+    // open in https://ui.perfetto.dev
+    server.addTraceEndpoint("/trace");
+#endif
+
+    server.addEndpoint(HTTPMethod::Get, "/api/partition/{label}", [](Request &req) {
+        auto &label = req.getPathVar("label");
+        LOG("GET /api/partition/{label}: label=%s", label.c_str());
+
+        auto partition = esp_partition_find_first(ESP_PARTITION_TYPE_ANY, ESP_PARTITION_SUBTYPE_ANY, label.c_str());
+
+        if (partition == nullptr) {
+            req.response().error404();
+            return;
+        }
+
+        auto resp = req.response();
+        resp.setType(HTTPD_TYPE_OCTET);
+        resp.writePartition(partition);
+    });
+
+    server.addEndpoint(HTTPMethod::Get, "/embedded/{file}*", EmbeddedAssetHandler(web::assets));
+
+    server.addEndpoint(HTTPMethod::Get, "/{file}*", StaticFileHandler("/spiffs"));
+
+    auto events = server.addEventSource("/api/events");
+
+    // echoes the messages back to the sender
+    std::shared_ptr<WebSocket> echo;
+
+    echo = server.addWebSocketEndpoint("/api/ws", {
+        .onMessage = [&echo](WebSocket::ClientId client, const WebSocket::Frame &frame) {
+            LOG("WS /api/ws: client=%i, size=%i", client, frame.payload.size());
+            echo->send(client, frame.payload, frame.type);
         }
     });
 
@@ -207,6 +333,7 @@ extern "C" [[noreturn]] void app_main() {
 
     while (true) {
         printf("\e[1A\e[Kuptime: %llum %llus\n", time / 60, time % 60);
+        events->broadcast(std::to_string(time), "uptime");
         sleep(5);
         time += 5;
     }
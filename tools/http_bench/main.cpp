@@ -0,0 +1,745 @@
+/*
+ * Load generator for exp_http_server, e.g. the http_server example running on a device
+ * or on the Linux target. Reports the throughput and the latency percentiles as JSON,
+ * so the results can be compared across commits.
+ *
+ * Build:
+ *     cmake -S tools/http_bench -B build/http_bench && cmake --build build/http_bench
+ *
+ * Usage:
+ *     http_bench <host> [--port 80] [--connections 4] [--duration 10] [--requests <count>]
+ *                [--no-keep-alive] [--mix echo=1,hello=4,static=1] [--body-size 1024]
+ *                [--name expressif] [--static-path /index.html] [--timeout 5] [--label <text>]
+ *
+ * Each connection is served by its own thread, which sends the requests one after
+ * another, picking the endpoint randomly according to the weights of the mix:
+ *     echo    POST /api/echo with --body-size bytes, the echoed body is verified
+ *     hello   GET /api/hello/{name}
+ *     static  GET --static-path
+ * The latency is measured from sending the request until the whole response is received,
+ * the time to the first byte separately (e.g. to spot Nagle's algorithm stalls).
+ */
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+enum class Kind {
+    Echo,
+    Hello,
+    Static
+};
+
+constexpr size_t KindCount = 3;
+constexpr const char *kindNames[KindCount] {"echo", "hello", "static"};
+
+struct Options {
+    std::string host;
+    std::string port {"80"};
+    size_t connections {4};
+    double duration {10};
+    std::optional<uint64_t> requests;
+    bool keepAlive {true};
+    unsigned weights[KindCount] {1, 4, 1};
+    size_t bodySize {1024};
+    std::string name {"expressif"};
+    std::string staticPath {"/index.html"};
+    double timeout {5};
+    std::string label;
+};
+
+struct Stats {
+    uint64_t requests {0};
+    uint64_t errors {0};
+    uint64_t statusClasses[5] {};
+    uint64_t bytesSent {0};
+    uint64_t bytesReceived {0};
+
+    // in microseconds
+    std::vector<uint32_t> latencies;
+    std::vector<uint32_t> firstByteLatencies;
+
+    void merge(const Stats &other) {
+        requests += other.requests;
+        errors += other.errors;
+
+        for (size_t i = 0; i < std::size(statusClasses); ++i)
+            statusClasses[i] += other.statusClasses[i];
+
+        bytesSent += other.bytesSent;
+        bytesReceived += other.bytesReceived;
+        latencies.insert(latencies.end(), other.latencies.begin(), other.latencies.end());
+        firstByteLatencies.insert(firstByteLatencies.end(), other.firstByteLatencies.begin(), other.firstByteLatencies.end());
+    }
+};
+
+[[noreturn]] static void fail(const char *message) {
+    fprintf(stderr, "http_bench: %s\n", message);
+    exit(2);
+}
+
+static void printUsage() {
+    fprintf(stderr,
+        "Usage: http_bench <host> [--port 80] [--connections 4] [--duration 10] [--requests <count>]\n"
+        "                  [--no-keep-alive] [--mix echo=1,hello=4,static=1] [--body-size 1024]\n"
+        "                  [--name expressif] [--static-path /index.html] [--timeout 5] [--label <text>]\n");
+}
+
+template<typename T>
+static T parseNumber(std::string_view str, const char *option) {
+    T value {};
+
+    if (auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value); ec != std::errc() || end != str.data() + str.size()) {
+        fprintf(stderr, "http_bench: invalid value of %s: %.*s\n", option, static_cast<int>(str.size()), str.data());
+        exit(2);
+    }
+
+    return value;
+}
+
+// e.g. echo=1,hello=4
+static void parseMix(std::string_view mix, unsigned (&weights)[KindCount]) {
+    std::fill(std::begin(weights), std::end(weights), 0);
+
+    while (!mix.empty()) {
+        auto item = mix.substr(0, mix.find(','));
+        mix.remove_prefix(std::min(mix.size(), item.size() + 1));
+
+        auto separator = item.find('=');
+        auto name = item.substr(0, separator);
+        auto weight = separator == std::string_view::npos ? 1 : parseNumber<unsigned>(item.substr(separator + 1), "--mix");
+
+        auto it = std::find(std::begin(kindNames), std::end(kindNames), name);
+
+        if (it == std::end(kindNames))
+            fail("unknown endpoint in --mix, expected echo, hello or static");
+
+        weights[it - std::begin(kindNames)] = weight;
+    }
+
+    if (std::all_of(std::begin(weights), std::end(weights), [](unsigned w) { return w == 0; }))
+        fail("--mix is empty");
+}
+
+static Options parseOptions(int argc, char *argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+
+        auto value = [&]() -> std::string_view {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "http_bench: %s requires a value\n", argv[i]);
+                exit(2);
+            }
+
+            return argv[++i];
+        };
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            exit(0);
+        } else if (arg == "--port") {
+            options.port = value();
+        } else if (arg == "--connections") {
+            options.connections = parseNumber<size_t>(value(), "--connections");
+        } else if (arg == "--duration") {
+            options.duration = parseNumber<double>(value(), "--duration");
+        } else if (arg == "--requests") {
+            options.requests = parseNumber<uint64_t>(value(), "--requests");
+        } else if (arg == "--no-keep-alive") {
+            options.keepAlive = false;
+        } else if (arg == "--mix") {
+            parseMix(value(), options.weights);
+        } else if (arg == "--body-size") {
+            options.bodySize = parseNumber<size_t>(value(), "--body-size");
+        } else if (arg == "--name") {
+            options.name = value();
+        } else if (arg == "--static-path") {
+            options.staticPath = value();
+        } else if (arg == "--timeout") {
+            options.timeout = parseNumber<double>(value(), "--timeout");
+        } else if (arg == "--label") {
+            options.label = value();
+        } else if (arg.starts_with("--") || !options.host.empty()) {
+            printUsage();
+            exit(2);
+        } else {
+            options.host = arg;
+        }
+    }
+
+    if (options.host.empty()) {
+        printUsage();
+        exit(2);
+    }
+
+    if (options.connections == 0)
+        fail("--connections must be positive");
+
+    return options;
+}
+
+/**
+ * The blocking client connection with a receive buffer.
+ */
+class Connection {
+public:
+    Connection(const addrinfo *address, double timeout)
+        : m_address(address), m_timeout(timeout) {}
+
+    ~Connection() {
+        close();
+    }
+
+    bool isOpen() const {
+        return m_fd >= 0;
+    }
+
+    bool open() {
+        m_fd = socket(m_address->ai_family, m_address->ai_socktype, m_address->ai_protocol);
+
+        if (m_fd < 0)
+            return false;
+
+        timeval timeout {
+            .tv_sec = static_cast<time_t>(m_timeout),
+            .tv_usec = static_cast<suseconds_t>((m_timeout - std::floor(m_timeout)) * 1e6)
+        };
+
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(m_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        // the client must not add delays of its own
+        int flag = 1;
+        setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+        if (connect(m_fd, m_address->ai_addr, m_address->ai_addrlen) != 0) {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void close() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+
+        m_begin = m_end = 0;
+    }
+
+    bool sendAll(std::string_view data) {
+        while (!data.empty()) {
+            auto ret = send(m_fd, data.data(), data.size(), MSG_NOSIGNAL);
+
+            if (ret <= 0)
+                return false;
+
+            data.remove_prefix(ret);
+        }
+
+        return true;
+    }
+
+    // reads the line without CRLF
+    bool readLine(std::string &line) {
+        line.clear();
+
+        while (true) {
+            auto data = std::string_view(m_buffer + m_begin, m_end - m_begin);
+
+            if (auto pos = data.find('\n'); pos != std::string_view::npos) {
+                line.append(data.substr(0, pos));
+                m_begin += pos + 1;
+
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+
+                return true;
+            }
+
+            line.append(data);
+            m_begin = m_end;
+
+            if (line.size() > 8192 || !fill())
+                return false;
+        }
+    }
+
+    /**
+     * Reads exactly `size` bytes.
+     * @param sink If set, the data is appended to it
+     */
+    bool read(size_t size, std::string *sink) {
+        while (size > 0) {
+            if (m_begin == m_end && !fill())
+                return false;
+
+            auto n = std::min(size, m_end - m_begin);
+
+            if (sink != nullptr)
+                sink->append(m_buffer + m_begin, n);
+
+            m_begin += n;
+            size -= n;
+        }
+
+        return true;
+    }
+
+    // reads until the server closes the connection
+    bool readToEnd(std::string *sink, uint64_t &size) {
+        while (true) {
+            size += m_end - m_begin;
+
+            if (sink != nullptr)
+                sink->append(m_buffer + m_begin, m_end - m_begin);
+
+            m_begin = m_end;
+
+            auto ret = recv(m_fd, m_buffer, sizeof(m_buffer), 0);
+
+            if (ret == 0)
+                return true;
+
+            if (ret < 0)
+                return false;
+
+            m_end = ret;
+            m_begin = 0;
+        }
+    }
+
+    /**
+     * Waits for the first byte of the response.
+     */
+    bool waitForData() {
+        return m_begin != m_end || fill();
+    }
+
+private:
+    bool fill() {
+        auto ret = recv(m_fd, m_buffer, sizeof(m_buffer), 0);
+
+        if (ret <= 0)
+            return false;
+
+        m_begin = 0;
+        m_end = ret;
+
+        return true;
+    }
+
+private:
+    const addrinfo *m_address;
+    double m_timeout;
+    int m_fd {-1};
+    char m_buffer[16384];
+    size_t m_begin {0};
+    size_t m_end {0};
+};
+
+struct Response {
+    int status {0};
+    bool isClosed {false};
+    uint64_t bodySize {0};
+};
+
+static bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+// the path segment, RFC 3986: everything but the unreserved characters is escaped
+static std::string encodePathSegment(std::string_view str) {
+    constexpr char hex[] = "0123456789ABCDEF";
+
+    std::string result;
+    result.reserve(str.size());
+
+    for (unsigned char c : str) {
+        if (std::isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~') {
+            result += static_cast<char>(c);
+        } else {
+            result += '%';
+            result += hex[c >> 4];
+            result += hex[c & 0xf];
+        }
+    }
+
+    return result;
+}
+
+static std::string_view trim(std::string_view str) {
+    while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+        str.remove_prefix(1);
+
+    while (!str.empty() && (str.back() == ' ' || str.back() == '\t'))
+        str.remove_suffix(1);
+
+    return str;
+}
+
+// supports Content-Length, chunked and close-delimited bodies
+static bool readResponse(Connection &connection, Response &response, std::string *body) {
+    std::string line;
+
+    if (!connection.readLine(line) || !line.starts_with("HTTP/1.") || line.size() < 12)
+        return false;
+
+    response.status = parseNumber<int>(std::string_view(line).substr(9, 3), "status");
+
+    // HTTP/1.0 closes the connection by default
+    response.isClosed = line.starts_with("HTTP/1.0");
+
+    std::optional<uint64_t> contentLength;
+    bool isChunked = false;
+
+    while (true) {
+        if (!connection.readLine(line))
+            return false;
+
+        if (line.empty())
+            break;
+
+        auto separator = line.find(':');
+
+        if (separator == std::string::npos)
+            continue;
+
+        auto name = std::string_view(line).substr(0, separator);
+        auto value = trim(std::string_view(line).substr(separator + 1));
+
+        if (iequals(name, "Content-Length")) {
+            contentLength = parseNumber<uint64_t>(value, "Content-Length");
+        } else if (iequals(name, "Transfer-Encoding")) {
+            isChunked = iequals(value, "chunked");
+        } else if (iequals(name, "Connection")) {
+            response.isClosed = iequals(value, "close") || (response.isClosed && !iequals(value, "keep-alive"));
+        }
+    }
+
+    if (isChunked) {
+        while (true) {
+            if (!connection.readLine(line))
+                return false;
+
+            uint64_t size = 0;
+            auto hex = std::string_view(line).substr(0, line.find(';'));
+
+            if (std::from_chars(hex.data(), hex.data() + hex.size(), size, 16).ec != std::errc())
+                return false;
+
+            if (size == 0) {
+                // trailers
+                do {
+                    if (!connection.readLine(line))
+                        return false;
+                } while (!line.empty());
+
+                return true;
+            }
+
+            if (!connection.read(size, body) || !connection.readLine(line))
+                return false;
+
+            response.bodySize += size;
+        }
+    }
+
+    if (contentLength.has_value()) {
+        response.bodySize = *contentLength;
+        return connection.read(*contentLength, body);
+    }
+
+    // neither: the body ends with the connection
+    response.isClosed = true;
+
+    if (response.status == 204 || response.status == 304)
+        return true;
+
+    return connection.readToEnd(body, response.bodySize);
+}
+
+static std::string makeRequest(const Options &options, Kind kind, const std::string &body) {
+    std::string request;
+
+    auto addHeaders = [&] {
+        request += "Host: " + options.host + "\r\n";
+
+        if (!options.keepAlive)
+            request += "Connection: close\r\n";
+    };
+
+    switch (kind) {
+        case Kind::Echo:
+            request = "POST /api/echo HTTP/1.1\r\n";
+            addHeaders();
+            request += "Content-Type: application/octet-stream\r\n";
+            request += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+            request += body;
+            break;
+        case Kind::Hello:
+            request = "GET /api/hello/" + encodePathSegment(options.name) + " HTTP/1.1\r\n";
+            addHeaders();
+            request += "\r\n";
+            break;
+        case Kind::Static:
+            request = "GET " + options.staticPath + " HTTP/1.1\r\n";
+            addHeaders();
+            request += "\r\n";
+            break;
+    }
+
+    return request;
+}
+
+struct Worker {
+    Stats stats[KindCount];
+};
+
+static void runWorker(
+    const Options &options, const addrinfo *address, size_t index,
+    Clock::time_point deadline, std::atomic<uint64_t> &remaining, Worker &worker
+) {
+    std::string body(options.bodySize, '\0');
+
+    for (size_t i = 0; i < body.size(); ++i)
+        body[i] = static_cast<char>('a' + (i * 7 + index) % 26);
+
+    std::string requests[KindCount];
+
+    for (size_t i = 0; i < KindCount; ++i)
+        requests[i] = makeRequest(options, static_cast<Kind>(i), body);
+
+    // deterministic, so the runs are comparable
+    std::mt19937 random(static_cast<uint32_t>(index + 1));
+    std::discrete_distribution<size_t> pick(std::begin(options.weights), std::end(options.weights));
+
+    Connection connection(address, options.timeout);
+    std::string echoed;
+
+    while (Clock::now() < deadline) {
+        if (options.requests.has_value()) {
+            auto left = remaining.load(std::memory_order_relaxed);
+
+            do {
+                if (left == 0)
+                    return;
+            } while (!remaining.compare_exchange_weak(left, left - 1, std::memory_order_relaxed));
+        }
+
+        auto kind = static_cast<Kind>(pick(random));
+        auto &stats = worker.stats[static_cast<size_t>(kind)];
+        auto &request = requests[static_cast<size_t>(kind)];
+
+        // the connection time is a part of the latency, as the clients see it
+        auto start = Clock::now();
+
+        Response response;
+        bool isSuccessful = (connection.isOpen() || connection.open()) && connection.sendAll(request);
+        auto firstByte = start;
+
+        if (isSuccessful) {
+            isSuccessful = connection.waitForData();
+            firstByte = Clock::now();
+        }
+
+        echoed.clear();
+
+        if (isSuccessful)
+            isSuccessful = readResponse(connection, response, kind == Kind::Echo ? &echoed : nullptr);
+
+        auto end = Clock::now();
+
+        if (isSuccessful && kind == Kind::Echo && response.status == 200 && echoed != body)
+            isSuccessful = false;
+
+        ++stats.requests;
+
+        if (!isSuccessful) {
+            ++stats.errors;
+            connection.close();
+            continue;
+        }
+
+        if (response.status >= 100 && response.status < 600)
+            ++stats.statusClasses[response.status / 100 - 1];
+
+        stats.bytesSent += request.size();
+        stats.bytesReceived += response.bodySize;
+
+        using std::chrono::duration_cast, std::chrono::microseconds;
+        stats.latencies.push_back(duration_cast<microseconds>(end - start).count());
+        stats.firstByteLatencies.push_back(duration_cast<microseconds>(firstByte - start).count());
+
+        if (!options.keepAlive || response.isClosed)
+            connection.close();
+    }
+}
+
+// nearest-rank, in milliseconds
+static double percentile(const std::vector<uint32_t> &sorted, double p) {
+    if (sorted.empty())
+        return 0;
+
+    auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1] / 1000.0;
+}
+
+static void printLatencies(const char *name, std::vector<uint32_t> &latencies) {
+    std::sort(latencies.begin(), latencies.end());
+
+    double sum = 0;
+
+    for (auto latency : latencies)
+        sum += latency;
+
+    auto mean = latencies.empty() ? 0 : sum / static_cast<double>(latencies.size()) / 1000.0;
+    auto max = latencies.empty() ? 0 : latencies.back() / 1000.0;
+
+    printf("\"%s\": {\"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}",
+           name, mean, percentile(latencies, 0.5), percentile(latencies, 0.9),
+           percentile(latencies, 0.99), percentile(latencies, 0.999), max);
+}
+
+static void printStats(Stats &stats, double seconds) {
+    printf("\"requests\": %llu, \"errors\": %llu, ",
+           static_cast<unsigned long long>(stats.requests), static_cast<unsigned long long>(stats.errors));
+
+    printf("\"status\": {");
+
+    for (size_t i = 0; i < std::size(stats.statusClasses); ++i)
+        printf("%s\"%zuxx\": %llu", i == 0 ? "" : ", ", i + 1, static_cast<unsigned long long>(stats.statusClasses[i]));
+
+    auto completed = static_cast<double>(stats.requests - stats.errors);
+
+    printf("}, \"req_per_s\": %.2f, \"mb_per_s\": %.4f, \"mb_sent_per_s\": %.4f, ",
+           completed / seconds, static_cast<double>(stats.bytesReceived) / 1e6 / seconds,
+           static_cast<double>(stats.bytesSent) / 1e6 / seconds);
+
+    printf("\"latency_ms\": {");
+    printLatencies("total", stats.latencies);
+    printf(", ");
+    printLatencies("first_byte", stats.firstByteLatencies);
+    printf("}");
+}
+
+// the strings are passed by the user, only quotes and backslashes are expected
+static void printString(const std::string &str) {
+    putchar('"');
+
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            putchar('\\');
+
+        if (static_cast<unsigned char>(c) >= 0x20)
+            putchar(c);
+    }
+
+    putchar('"');
+}
+
+int main(int argc, char *argv[]) {
+    auto options = parseOptions(argc, argv);
+
+    addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo *address = nullptr;
+
+    if (int ret = getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &address); ret != 0) {
+        fprintf(stderr, "http_bench: cannot resolve %s: %s\n", options.host.c_str(), gai_strerror(ret));
+        return 2;
+    }
+
+    std::vector<Worker> workers(options.connections);
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> remaining {options.requests.value_or(0)};
+
+    // without the duration, runs until the requests are sent
+    auto duration = options.requests.has_value() && options.duration <= 0 ? 1e9 : options.duration;
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(duration));
+
+    for (size_t i = 0; i < options.connections; ++i) {
+        threads.emplace_back(runWorker, std::cref(options), address, i, deadline, std::ref(remaining), std::ref(workers[i]));
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    freeaddrinfo(address);
+
+    Stats total;
+    Stats perKind[KindCount];
+
+    for (auto &worker : workers) {
+        for (size_t i = 0; i < KindCount; ++i) {
+            perKind[i].merge(worker.stats[i]);
+            total.merge(worker.stats[i]);
+        }
+    }
+
+    printf("{\"label\": ");
+    printString(options.label);
+    printf(", \"config\": {\"host\": ");
+    printString(options.host);
+    printf(", \"port\": ");
+    printString(options.port);
+    printf(", \"connections\": %zu, \"keep_alive\": %s, \"body_size\": %zu, \"mix\": {",
+           options.connections, options.keepAlive ? "true" : "false", options.bodySize);
+
+    for (size_t i = 0; i < KindCount; ++i)
+        printf("%s\"%s\": %u", i == 0 ? "" : ", ", kindNames[i], options.weights[i]);
+
+    printf("}}, \"duration_s\": %.3f, ", seconds);
+    printStats(total, seconds);
+    printf(", \"endpoints\": {");
+
+    bool isFirst = true;
+
+    for (size_t i = 0; i < KindCount; ++i) {
+        if (options.weights[i] == 0)
+            continue;
+
+        printf("%s\"%s\": {", isFirst ? "" : ", ", kindNames[i]);
+        printStats(perKind[i], seconds);
+        printf("}");
+
+        isFirst = false;
+    }
+
+    printf("}}\n");
+
+    return total.errors == 0 ? 0 : 1;
+}